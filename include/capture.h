@@ -0,0 +1,44 @@
+#ifndef _CAPTURE_H
+#define _CAPTURE_H
+
+// Captura assíncrona dos quadros desenhados. Cada quadro capturado é copiado
+// pela GPU para um pixel buffer object (glReadPixels com GL_PIXEL_PACK_BUFFER
+// retorna sem esperar a GPU) de um anel de CAPTURE_RING buffers, que só é
+// lido pela CPU quando o buffer volta a ser usado, alguns quadros depois. A
+// codificação e a gravação dos arquivos, e a comparação com imagens de
+// referência, são feitas em uma thread separada. Assim a captura quase não
+// custa nada para a thread que desenha e pode ser ligada durante as medições
+// (veja o modo "--offscreen" em main.cpp).
+
+enum CaptureFormat
+{
+    CAPTURE_PNG, // PNG RGBA sem compressão
+    CAPTURE_RAW  // Pixels RGBA de 8 bits, linha de cima primeiro, sem cabeçalho
+};
+
+struct CaptureOptions
+{
+    const char* directory;        // Onde gravar frame_NNNNN.png/.raw; NULL para não gravar
+    CaptureFormat format;
+    int every;                    // Captura um a cada "every" quadros
+    const char* golden_directory; // Imagens de referência frame_NNNNN.png; NULL para não comparar
+    int tolerance;                // Diferença máxima aceita por canal na comparação
+
+    CaptureOptions()
+        : directory(NULL), format(CAPTURE_PNG), every(1), golden_directory(NULL), tolerance(2) {}
+};
+
+// Cria os buffers e inicia a thread de gravação. Exige um contexto OpenGL
+// corrente. Retorna false (imprimindo o motivo) em caso de erro.
+bool Capture_Start(const CaptureOptions& options);
+
+// Chamada uma vez por quadro, depois de desenhá-lo e antes de trocar os
+// buffers, com o framebuffer a ser lido ligado. Não faz nada se a captura
+// não foi iniciada.
+void Capture_Frame(int width, int height);
+
+// Lê os quadros ainda pendentes, espera a thread de gravação terminar e
+// imprime o resumo da captura e da comparação.
+void Capture_Finish();
+
+#endif // _CAPTURE_H
@@ -0,0 +1,36 @@
+#ifndef _DYNAMIC_RESOLUTION_H
+#define _DYNAMIC_RESOLUTION_H
+
+// Resolução dinâmica da cena 3D. O tempo de GPU da cena é medido a cada
+// quadro (GL_TIME_ELAPSED, lido sem esperar a GPU) e comparado a um
+// orçamento: acima dele a cena passa a ser desenhada em um framebuffer
+// object menor, ampliado para a janela com glBlitFramebuffer(); com folga
+// a escala volta a subir. O HUD (mira e texto) é desenhado depois, sempre
+// na resolução da janela. Com escala 1 a cena vai direto para a janela,
+// sem cópia.
+
+// Liga o controle com um orçamento de "budget_ms" milissegundos de GPU para
+// a cena, com escala (em cada eixo) de no mínimo "min_scale". Exige um
+// contexto OpenGL corrente. Enquanto não for chamada, as funções abaixo
+// desenham na resolução da janela.
+void DynamicResolution_Init(double budget_ms, float min_scale);
+
+bool DynamicResolution_Enabled();
+
+// Delimitam o desenho da cena para uma janela de "width" x "height" pixels.
+// DynamicResolution_BeginScene() liga o framebuffer e o viewport na escala
+// atual; DynamicResolution_EndScene() amplia o resultado para a janela e
+// volta ao framebuffer e ao viewport dela.
+void DynamicResolution_BeginScene(int width, int height);
+void DynamicResolution_EndScene();
+
+// Escala atual, em cada eixo (1 = resolução da janela).
+float DynamicResolution_Scale();
+
+// Tempo de GPU da cena, média móvel, em milissegundos.
+double DynamicResolution_SceneMs();
+
+// Apaga o framebuffer e as consultas.
+void DynamicResolution_Finish();
+
+#endif // _DYNAMIC_RESOLUTION_H
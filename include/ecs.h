@@ -0,0 +1,162 @@
+#ifndef _ECS_H
+#define _ECS_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+// Armazenamento de entidades por arquétipo. Um arquétipo é uma combinação
+// fixa de componentes (ex: alvo parado = Transform + Health + Lifetime +
+// Renderable + Collider); todas as entidades com a mesma combinação ficam
+// na mesma tabela, com um vetor contíguo por componente. Os sistemas
+// percorrem esses vetores linearmente, e o tipo de uma entidade é dado pelo
+// arquétipo em que ela está, sem herança nem testes de tipo por entidade.
+
+// Posição no mundo e escala uniforme.
+struct Transform
+{
+    float x, y, z;
+    float scale;
+};
+
+// Slot da trajetória da entidade na MotionPool (veja motion.h).
+struct Motion
+{
+    int slot;
+};
+
+struct Health
+{
+    int hp;
+    int points; // Pontos ganhos pelo jogador ao destruir a entidade
+};
+
+// Instante (tempo de glfwGetTime()) em que a entidade expira. A remoção é
+// feita pelo evento EVENT_TARGET_EXPIRED (veja scheduler.h).
+struct Lifetime
+{
+    double expire_time;
+};
+
+// Objeto desenhado com DrawVirtualObject(): "object_id" é o valor enviado ao
+// fragment shader e "mesh" o nome do objeto em g_VirtualScene.
+struct Renderable
+{
+    int object_id;
+    const char* mesh;
+};
+
+// Esfera de colisão centrada no Transform.
+struct Collider
+{
+    float radius;
+};
+
+// Matriz "model" completa, para objetos fixos que não são só uma posição e
+// uma escala (ex: chão, paredes e teto do mapa).
+struct StaticModel
+{
+    glm::mat4 model;
+};
+
+enum ComponentBit
+{
+    COMPONENT_TRANSFORM    = 1 << 0,
+    COMPONENT_MOTION       = 1 << 1,
+    COMPONENT_HEALTH       = 1 << 2,
+    COMPONENT_LIFETIME     = 1 << 3,
+    COMPONENT_RENDERABLE   = 1 << 4,
+    COMPONENT_COLLIDER     = 1 << 5,
+    COMPONENT_STATIC_MODEL = 1 << 6
+};
+
+typedef uint32_t ComponentMask;
+
+// Identificador de entidade: índice (20 bits) e geração (11 bits). A geração
+// muda quando o índice é reutilizado, de forma que identificadores antigos
+// (ex: guardados em um evento agendado) deixam de ser válidos. Cabe em um
+// int para ser usado como payload de eventos.
+typedef int EntityId;
+const EntityId INVALID_ENTITY = -1;
+
+// Maior número de entidades existindo ao mesmo tempo: os índices têm 20
+// bits. World::Create() encerra o programa se passar disso.
+const int ENTITY_MAX_COUNT = 1 << 20;
+
+// Tabela de um arquétipo. Somente os vetores dos componentes presentes em
+// "mask" são usados; os demais ficam vazios. A linha i de cada vetor
+// pertence à entidade entities[i].
+struct Archetype
+{
+    ComponentMask mask;
+    std::vector<EntityId> entities;
+    std::vector<Transform> transforms;
+    std::vector<Motion> motions;
+    std::vector<Health> healths;
+    std::vector<Lifetime> lifetimes;
+    std::vector<Renderable> renderables;
+    std::vector<Collider> colliders;
+    std::vector<StaticModel> static_models;
+
+    size_t Size() const { return entities.size(); }
+
+    // true se o arquétipo possui todos os componentes de "required" e
+    // nenhum de "excluded".
+    bool Matches(ComponentMask required, ComponentMask excluded = 0) const
+    {
+        return (mask & required) == required && (mask & excluded) == 0;
+    }
+};
+
+class World
+{
+public:
+    // Cria uma entidade com os componentes de "mask", inicializados com
+    // zero. Os valores são preenchidos pelos métodos Get*().
+    EntityId Create(ComponentMask mask);
+
+    // Remove a entidade, movendo a última linha do arquétipo para o lugar
+    // dela. Identificadores inválidos ou já removidos são ignorados.
+    void Destroy(EntityId id);
+
+    bool IsAlive(EntityId id) const;
+
+    // Componentes de uma entidade viva que os possua; NULL caso contrário.
+    Transform* GetTransform(EntityId id);
+    Motion* GetMotion(EntityId id);
+    Health* GetHealth(EntityId id);
+    Lifetime* GetLifetime(EntityId id);
+    Renderable* GetRenderable(EntityId id);
+    Collider* GetCollider(EntityId id);
+    StaticModel* GetStaticModel(EntityId id);
+
+    // Tabelas de todos os arquétipos, para iteração pelos sistemas. Novos
+    // arquétipos são adicionados no fim; os existentes nunca mudam de índice.
+    std::vector<Archetype>& Archetypes() { return archetypes_; }
+    const std::vector<Archetype>& Archetypes() const { return archetypes_; }
+
+    // Número de entidades vivas com todos os componentes de "required".
+    size_t Count(ComponentMask required) const;
+
+    // Remove todas as entidades.
+    void Clear();
+
+private:
+    struct EntityRecord
+    {
+        int archetype; // -1 para índices livres
+        int row;
+        int generation;
+    };
+
+    int FindOrAddArchetype(ComponentMask mask);
+    bool Locate(EntityId id, Archetype** archetype, size_t* row);
+
+    std::vector<Archetype> archetypes_;
+    std::vector<EntityRecord> records_;
+    std::vector<int> free_indices_;
+};
+
+#endif // _ECS_H
@@ -0,0 +1,30 @@
+#ifndef _FRAME_FENCES_H
+#define _FRAME_FENCES_H
+
+// Limite de quadros em voo. Sem ele o driver pode aceitar vários quadros à
+// frente da GPU, e cada quadro na fila soma um quadro de latência entre a
+// entrada do usuário e a tela. Após a troca de buffers, FrameFences_EndFrame()
+// coloca uma fence (glFenceSync()) no fim do quadro e espera
+// (glClientWaitSync()) a fence de "max_frames" quadros atrás: com 1 a CPU só
+// começa o próximo quadro com a GPU livre (menor latência, menos
+// paralelismo); com 3 a GPU tem mais trabalho na fila (maior vazão). O tempo
+// esperado indica quanto a GPU é o gargalo.
+
+// Maior limite aceito.
+const int FRAME_FENCES_MAX = 3;
+
+// Define o limite (1 a FRAME_FENCES_MAX; 0 desliga). Exige um contexto
+// OpenGL corrente.
+void FrameFences_Init(int max_frames);
+
+// Encerra o quadro: cria a sua fence e espera a do quadro mais antigo
+// permitido na fila.
+void FrameFences_EndFrame();
+
+// Tempo esperado pela GPU no último quadro, em milissegundos.
+double FrameFences_LastWaitMs();
+
+// Imprime as estatísticas das esperas e apaga as fences pendentes.
+void FrameFences_Finish();
+
+#endif // _FRAME_FENCES_H
@@ -0,0 +1,56 @@
+#ifndef _GL_DEBUG_H
+#define _GL_DEBUG_H
+
+#include <glad/glad.h>
+
+// Camada de depuração OpenGL. Nas builds de depuração (sem NDEBUG) usa a
+// extensão GL_KHR_debug, ou GL_ARB_debug_output se só ela existir: o driver
+// chama uma função nossa para cada erro ou aviso, no momento da chamada
+// OpenGL que o causou, e os objetos e as etapas do desenho recebem nomes
+// que aparecem nas mensagens e em ferramentas como o RenderDoc. Nenhuma
+// chamada a glGetError() é feita, então a CPU nunca espera pela GPU por
+// causa da verificação de erros.
+//
+// Nas builds de release (com NDEBUG) as macros abaixo não geram código
+// algum e GlDebug_Init() não faz nada.
+
+#ifndef NDEBUG
+#define GL_DEBUG_ENABLED 1
+#endif
+
+// Tipos de objeto de glObjectLabel() que não existem no OpenGL 3.3.
+#ifndef GL_BUFFER
+#define GL_BUFFER  0x82E0
+#define GL_SHADER  0x82E1
+#define GL_PROGRAM 0x82E2
+#define GL_QUERY   0x82E3
+#define GL_SAMPLER 0x82E6
+#endif
+
+// Liga as mensagens de depuração do contexto atual, com as funções da
+// extensão obtidas por "load". Retorna false se nenhuma das extensões
+// existir ou se a camada não foi compilada.
+bool GlDebug_Init(GLADloadproc load);
+
+// Nome de um objeto OpenGL ("identifier" é GL_BUFFER, GL_TEXTURE, ...).
+void GlDebug_Label(GLenum identifier, GLuint name, const char* label);
+
+// Delimita um grupo de comandos (ex: uma etapa do desenho).
+void GlDebug_PushGroup(const char* name);
+void GlDebug_PopGroup();
+
+#ifdef GL_DEBUG_ENABLED
+
+#define GL_DEBUG_LABEL(identifier, name, label) GlDebug_Label(identifier, name, label)
+#define GL_DEBUG_PUSH_GROUP(name) GlDebug_PushGroup(name)
+#define GL_DEBUG_POP_GROUP() GlDebug_PopGroup()
+
+#else
+
+#define GL_DEBUG_LABEL(identifier, name, label) ((void)0)
+#define GL_DEBUG_PUSH_GROUP(name) ((void)0)
+#define GL_DEBUG_POP_GROUP() ((void)0)
+
+#endif // GL_DEBUG_ENABLED
+
+#endif // _GL_DEBUG_H
@@ -0,0 +1,31 @@
+#ifndef _GL_STATE_H
+#define _GL_STATE_H
+
+// Cache do estado OpenGL. GlState_Install() troca os ponteiros de função da
+// GLAD das chamadas que só alteram estado (glUseProgram, glBindVertexArray,
+// glBindBuffer, glActiveTexture, glBindTexture, glBindSampler, glEnable e
+// glDisable de GL_BLEND, GL_DEPTH_TEST e GL_CULL_FACE, glBlendFunc,
+// glDepthFunc, glDepthMask e glPolygonMode) por funções que guardam o
+// último valor enviado ao driver e descartam as chamadas que não o mudam.
+// Assim cada trecho de desenho pode ligar o estado de que precisa sem
+// custo quando ele já está ligado.
+//
+// O estado começa desconhecido: a primeira chamada de cada tipo sempre
+// chega ao driver. As chamadas glDelete* dos objetos em cache também
+// passam pelo cache, já que apagar um objeto ligado o desliga.
+
+// Instala o cache. Exige as funções OpenGL já carregadas pela GLAD. Para que
+// os contadores de gl_stats.h vejam só as chamadas que chegam ao driver, o
+// cache deve ser instalado depois deles.
+void GlState_Install();
+
+bool GlState_Installed();
+
+// Esquece o estado guardado, para quando o estado OpenGL for alterado sem
+// passar pela GLAD (ex: por outra biblioteca).
+void GlState_Invalidate();
+
+// Número de chamadas descartadas desde a chamada anterior.
+unsigned int GlState_TakeSkipped();
+
+#endif // _GL_STATE_H
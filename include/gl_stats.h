@@ -0,0 +1,42 @@
+#ifndef _GL_STATS_H
+#define _GL_STATS_H
+
+#include <stdint.h>
+
+// Contadores das chamadas OpenGL de cada quadro. GlStats_Install() troca os
+// ponteiros de função da GLAD (glad_glDrawArrays, glad_glUseProgram, ...)
+// por funções que contam a chamada e chamam a original; sem ela nenhuma
+// chamada passa pelos contadores e não há custo algum.
+
+struct GlFrameStats
+{
+    unsigned int draw_calls;      // glDraw*
+    uint64_t triangles;           // Triângulos desenhados, contando as instâncias
+    unsigned int program_binds;   // glUseProgram
+    unsigned int vao_binds;       // glBindVertexArray
+    unsigned int texture_binds;   // glBindTexture
+    unsigned int buffer_uploads;  // glBufferData e glBufferSubData
+    uint64_t buffer_upload_bytes;
+    unsigned int uniform_updates; // glUniform*
+    unsigned int state_skipped;   // Chamadas descartadas pelo cache de gl_state.h
+};
+
+// Instala os contadores. Exige as funções OpenGL já carregadas pela GLAD.
+// Com "csv_path" diferente de NULL, grava uma linha por quadro no arquivo.
+// Retorna false (imprimindo o motivo) se o arquivo não puder ser criado.
+bool GlStats_Install(const char* csv_path);
+
+bool GlStats_Installed();
+
+// Encerra o quadro: os contadores atuais passam a ser os do último quadro
+// e são zerados. As chamadas descartadas pelo cache de estado (gl_state.h)
+// desde o quadro anterior são contadas neste quadro.
+void GlStats_EndFrame();
+
+// Contadores do último quadro encerrado.
+const GlFrameStats& GlStats_LastFrame();
+
+// Fecha o CSV e imprime a média por quadro.
+void GlStats_Finish();
+
+#endif // _GL_STATS_H
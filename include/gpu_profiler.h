@@ -0,0 +1,50 @@
+#ifndef _GPU_PROFILER_H
+#define _GPU_PROFILER_H
+
+// Tempo de GPU de cada etapa do desenho de um quadro. Cada trecho medido é
+// delimitado por duas consultas GL_TIMESTAMP (glQueryCounter()), então uma
+// etapa pode ser medida em vários trechos no mesmo quadro (ex: o mapa e os
+// alvos parados, desenhados intercalados por RenderSystem_Draw()). As
+// consultas de um quadro só são lidas GPU_PROFILER_FRAMES quadros depois; se
+// ainda não estiverem prontas o quadro é descartado, sem esperar a GPU.
+
+enum GpuPass
+{
+    GPU_PASS_MAP,       // Mapa (paredes e chão)
+    GPU_PASS_TARGETS,   // Alvos parados e em movimento
+    GPU_PASS_GUN,       // RenderGun()
+    GPU_PASS_PLAYER,    // RenderPlayer(), só em terceira pessoa
+    GPU_PASS_CROSSHAIR, // drawCrosshair()
+    GPU_PASS_TEXT,      // Texto do HUD
+    GPU_PASS_COUNT
+};
+
+// Nome da etapa, usado no HUD e no JSON; GPU_PASS_COUNT é o quadro inteiro.
+const char* GpuProfiler_PassName(int pass);
+
+// Cria as consultas. Exige um contexto OpenGL corrente. Enquanto não for
+// chamada, todas as funções abaixo não fazem nada.
+void GpuProfiler_Init();
+
+// Delimitam um quadro. GpuProfiler_BeginFrame() também lê os resultados
+// do quadro que usou as mesmas consultas.
+void GpuProfiler_BeginFrame();
+void GpuProfiler_EndFrame();
+
+// Delimitam um trecho da etapa "pass". Fora de um quadro não fazem nada.
+void GpuProfiler_Begin(GpuPass pass);
+void GpuProfiler_End(GpuPass pass);
+
+bool GpuProfiler_Enabled();
+
+// Média do tempo da etapa (ou do quadro, com GPU_PASS_COUNT), em
+// milissegundos, nos últimos quadros lidos. Atualizada a cada 60 quadros,
+// para ser legível no HUD.
+double GpuProfiler_AverageMs(int pass);
+
+// Espera os quadros pendentes, grava o JSON com as estatísticas de cada
+// etapa e os tempos de todos os quadros lidos (se "json_path" não for
+// NULL) e destrói as consultas.
+void GpuProfiler_Finish(const char* json_path);
+
+#endif // _GPU_PROFILER_H
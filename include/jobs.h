@@ -0,0 +1,150 @@
+#ifndef _JOBS_H
+#define _JOBS_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+// Sistema de tarefas com roubo de trabalho. Cada thread trabalhadora tem a
+// sua fila (deque): ela coloca e retira tarefas no fim da própria fila, e
+// as threads sem trabalho roubam do início das filas das outras. As threads
+// que não são trabalhadoras (a principal, a da simulação) também têm cada
+// uma a sua fila.
+//
+// Quem espera um grupo de tarefas (Jobs_Wait()) executa as tarefas desse
+// grupo enquanto isso, e só elas: uma tarefa pode criar e esperar outras
+// (ex: um Jobs_ParallelFor() dentro de um nó de um JobGraph) sem travar o
+// sistema, e a thread do desenho não executa as tarefas da simulação nem o
+// contrário. Sem trabalhadoras (veja Jobs_Init()) tudo é executado na
+// thread que espera, na ordem de criação.
+
+// Maior número de threads trabalhadoras.
+#define JOBS_MAX_WORKERS 31
+
+// Maior número de outras threads com fila própria; as seguintes
+// compartilham a última.
+#define JOBS_MAX_THREADS 8
+
+// Maior número de blocos em que um Jobs_ParallelFor() divide o intervalo.
+#define JOBS_MAX_CHUNKS 64
+
+typedef void (*JobFunction)(void* data);
+
+// Função de um Jobs_ParallelFor(): processa os índices [begin, end).
+typedef void (*JobRangeFunction)(size_t begin, size_t end, void* data);
+
+// Chamada ao fim de cada tarefa com nome, na thread que a executou
+// ("worker" é 0 fora das trabalhadoras). Os instantes são nanossegundos de
+// std::chrono::steady_clock, medidos mesmo sem o perfil da CPU (veja
+// profiler.h). Pode ser chamada por várias threads ao mesmo tempo.
+typedef void (*JobTimingHook)(const char* name, int worker, uint64_t begin_ns, uint64_t end_ns, void* user);
+
+// Tarefas ainda não terminadas de um grupo.
+struct JobCounter
+{
+    std::atomic<int> pending;
+
+    JobCounter() : pending(0) {}
+
+private:
+    JobCounter(const JobCounter&);
+    JobCounter& operator=(const JobCounter&);
+};
+
+// Contadores desde Jobs_Init().
+struct JobStats
+{
+    uint64_t executed; // Tarefas executadas
+    uint64_t stolen;   // Tarefas roubadas da fila de outra thread
+};
+
+// Cria "workers" threads trabalhadoras (no máximo JOBS_MAX_WORKERS; menos
+// que 0 escolhe uma a menos que o número de núcleos). Encerra as anteriores,
+// se houver; não deve ser chamada com tarefas em andamento.
+void Jobs_Init(int workers);
+
+// Encerra as trabalhadoras. Também é chamada ao fim do programa.
+void Jobs_Shutdown();
+
+int Jobs_WorkerCount();
+
+// Coloca a tarefa na fila da thread atual. "name" (um literal, ou NULL para
+// não medir) aparece no perfil da CPU e no gancho de tempo. "counter" é
+// incrementado agora e decrementado quando a tarefa termina.
+void Jobs_Submit(const char* name, JobFunction function, void* data, JobCounter* counter);
+
+// Executa as tarefas do contador até que todas terminem.
+void Jobs_Wait(JobCounter* counter);
+
+// Divide [0, count) em blocos de pelo menos "grain" índices e os executa em
+// paralelo; a thread atual executa o primeiro bloco e espera os demais. Com
+// um único bloco (ou sem trabalhadoras) é uma chamada direta a "function".
+void Jobs_ParallelFor(const char* name, size_t count, size_t grain, JobRangeFunction function, void* data);
+
+// O mesmo, com qualquer objeto chamável como f(begin, end).
+template <typename Function>
+void Jobs_ParallelFor(const char* name, size_t count, size_t grain, const Function& function)
+{
+    struct Call
+    {
+        static void Range(size_t begin, size_t end, void* data)
+        {
+            (*static_cast<const Function*>(data))(begin, end);
+        }
+    };
+    Jobs_ParallelFor(name, count, grain, Call::Range, const_cast<Function*>(&function));
+}
+
+// Gancho de tempo das tarefas com nome; NULL o remove. Uma tarefa que já
+// terminou pode ainda chamar o gancho anterior, sempre com o seu "user".
+void Jobs_SetTimingHook(JobTimingHook hook, void* user);
+
+void Jobs_GetStats(JobStats* stats);
+
+// Grafo de dependências das etapas de um quadro. Cada nó é uma tarefa que
+// só começa depois que todos os nós de que depende terminaram; os nós
+// independentes rodam em paralelo. O grafo é montado uma vez e pode ser
+// executado a cada quadro.
+class JobGraph
+{
+public:
+    JobGraph() : graph_mutex_(), done_() {}
+
+    // Adiciona um nó e retorna o seu índice.
+    int Add(const char* name, JobFunction function, void* data);
+
+    // O nó "node" só começa depois que "dependency" terminar.
+    void Depends(int node, int dependency);
+
+    // Executa todos os nós e espera o último terminar.
+    void Run();
+
+    void Clear() { nodes_.clear(); }
+
+    size_t Size() const { return nodes_.size(); }
+
+private:
+    struct Node
+    {
+        const char* name;
+        JobFunction function;
+        void* data;
+        std::vector<int> successors;
+        int dependencies;
+        int remaining; // Dependências ainda não terminadas nesta execução
+        JobGraph* graph;
+    };
+
+    JobGraph(const JobGraph&);
+    JobGraph& operator=(const JobGraph&);
+
+    static void RunNode(void* data);
+
+    std::vector<Node> nodes_;
+    std::mutex graph_mutex_;
+    JobCounter done_;
+};
+
+#endif // _JOBS_H
@@ -0,0 +1,69 @@
+#ifndef _MOTION_H
+#define _MOTION_H
+
+#include <cstddef>
+#include <vector>
+
+// Parâmetros das trajetórias dos alvos em movimento (tipo 1), armazenados em
+// formato SoA. Cada alvo percorre o formato "shape" (veja PathShape em
+// "paths.h") escalado por "radius" em torno de (center_x, center_y, center_z),
+// com velocidade constante, a partir de "start_time" deslocado por "phase"
+// segundos.
+//
+// A trajetória é uma função fechada do tempo: a GPU a avalia no vertex shader
+// "shader_vertex_target_mov.glsl" a cada quadro, e a CPU só a avalia quando
+// precisa da posição (tiros e colisões próximas). Slots liberados são
+// reutilizados por alvos criados depois, de forma que os índices dos alvos
+// vivos nunca mudam e podem ser usados como índice de instância na GPU.
+struct MotionPool
+{
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+    std::vector<float> start_time;
+    std::vector<float> phase;
+    std::vector<int> shape;
+    std::vector<float> active; // 1.0 para alvos vivos, 0.0 para slots livres ou alvos destruídos
+
+    // Posições calculadas pela última chamada de Motion_EvaluateBatch().
+    std::vector<float> pos_x;
+    std::vector<float> pos_y;
+    std::vector<float> pos_z;
+
+    std::vector<int> free_slots;
+
+    // Slots alterados desde a última vez que o renderizador enviou os
+    // parâmetros para a GPU. O renderizador esvazia esta lista.
+    std::vector<int> dirty_slots;
+
+    // Reserva um slot para um novo alvo e retorna seu índice.
+    int Allocate(float cx, float cy, float cz, float r, float start, int path_shape, float phase_offset = 0.0f);
+
+    // Marca o alvo como destruído: ele deixa de ser desenhado, mas o slot só
+    // volta a ser usado depois de Release().
+    void Deactivate(int slot);
+
+    // Libera o slot de um alvo removido.
+    void Release(int slot);
+
+    // Número de slots (vivos ou livres). É também o número de instâncias
+    // desenhadas por DrawMovingTargets().
+    size_t Size() const { return radius.size(); }
+};
+
+// Avalia a posição de todos os slots da pool no instante "now" (mesmo relógio
+// usado em "start_time"). Chamada somente quando a CPU precisa de todas as
+// posições de uma vez (ex: em um tiro).
+void Motion_EvaluateBatch(MotionPool& pool, float now);
+
+// Avalia a posição de um único slot no instante "now": uma consulta na tabela
+// do formato, com interpolação linear (veja Paths_Sample()).
+void Motion_Evaluate(const MotionPool& pool, int slot, float now, float* x, float* y, float* z);
+
+// Retorna false se o alvo do slot certamente está a mais de "distance" do
+// ponto (x,y,z) em qualquer instante, sem avaliar a trajetória. Utilizado
+// para avaliar a posição somente quando ela pode causar uma colisão.
+bool Motion_MayBeNear(const MotionPool& pool, int slot, float x, float y, float z, float distance);
+
+#endif // _MOTION_H
@@ -0,0 +1,19 @@
+#ifndef _OFFSCREEN_H
+#define _OFFSCREEN_H
+
+// Contexto OpenGL 3.3 core sem janela nem display, para medir a renderização
+// em máquinas sem servidor X (ex: Mesa llvmpipe). Usa EGL com a plataforma
+// "surfaceless" da Mesa; a libEGL é carregada em tempo de execução, então o
+// programa não passa a depender dela. Fora do Linux não há suporte e a
+// criação sempre falha (veja o modo "--offscreen" em main.cpp, que então
+// usa uma janela GLFW invisível).
+
+// Cria o contexto e o torna corrente. Retorna false se não for possível.
+bool Offscreen_CreateContext();
+
+// Endereço de uma função OpenGL, para gladLoadGLLoader().
+void* Offscreen_GetProcAddress(const char* name);
+
+void Offscreen_DestroyContext();
+
+#endif // _OFFSCREEN_H
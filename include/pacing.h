@@ -0,0 +1,34 @@
+#ifndef _PACING_H
+#define _PACING_H
+
+// Limite da taxa de quadros. FrameLimiter_Wait() espera até o instante do
+// próximo quadro em duas partes: dorme em intervalos de 1 ms enquanto
+// sobra mais tempo do que o maior atraso esperado de uma dessas esperas
+// (medido durante a execução, já que o sistema pode acordar a thread bem
+// depois do pedido) e gira o restante, cedendo a CPU a cada volta. Assim
+// o intervalo entre quadros fica preciso sem ocupar um núcleo inteiro.
+
+struct FrameLimiter
+{
+    double interval;   // Segundos por quadro; 0 desliga o limite
+    double next_frame; // Instante (Pacing_Now()) do próximo quadro
+
+    // Duração das esperas de 1 ms já feitas: média e variância (algoritmo
+    // de Welford) e número de amostras.
+    double sleep_mean;
+    double sleep_m2;
+    unsigned int sleep_samples;
+};
+
+// Segundos desde o início do programa, em um relógio monotônico.
+double Pacing_Now();
+
+// Limite de "fps" quadros por segundo (0 ou menos: sem limite).
+void FrameLimiter_Init(FrameLimiter& limiter, double fps);
+
+// Espera até o instante do próximo quadro. Se o quadro atual já passou do
+// seu instante, não há espera e o próximo é contado a partir de agora, sem
+// quadros seguidos para recuperar o atraso.
+void FrameLimiter_Wait(FrameLimiter& limiter);
+
+#endif // _PACING_H
@@ -0,0 +1,60 @@
+#ifndef _PATHS_H
+#define _PATHS_H
+
+#include <vector>
+
+// Formatos de trajetória dos alvos em movimento. Todos são curvas fechadas de
+// tamanho unitário centradas na origem; cada alvo escala o formato pelo seu
+// raio e o posiciona no seu ponto de criação (veja MotionPool em motion.h).
+enum PathShape
+{
+    PATH_CIRCLE = 0,       // Círculo no plano XZ formado por 4 Béziers cúbicas
+    PATH_FIGURE_EIGHT = 1, // Oito (lemniscata de Gerono) no plano XZ
+    PATH_STRAFE = 2,       // Vai e volta em linha reta ao longo do eixo X
+    PATH_WAVE = 3,         // Spline de Catmull-Rom fechada, subindo e descendo
+    PATH_NUM_BUILTIN_SHAPES = 4
+};
+
+// Número máximo de formatos (embutidos + registrados com
+// Paths_AddCatmullRom()). Deve ser igual a PATH_MAX_SHAPES em
+// "shader_vertex_target_mov.glsl".
+const int PATH_MAX_SHAPES = 8;
+
+// Número de amostras de cada tabela, igualmente espaçadas em comprimento de
+// arco. Deve ser igual a PATH_TABLE_SIZE em "shader_vertex_target_mov.glsl".
+const int PATH_TABLE_SIZE = 256;
+
+// Tabela pré-calculada de um formato. "positions" guarda, para cada amostra
+// k, a posição da curva no parâmetro t(s) tal que o comprimento de arco até
+// ali é s = k/PATH_TABLE_SIZE do comprimento total. Assim, percorrer a tabela
+// com velocidade constante é percorrer a curva com velocidade constante.
+struct PathTable
+{
+    std::vector<float> positions; // x,y,z de cada amostra (3*PATH_TABLE_SIZE floats)
+    float length;                 // Comprimento total da curva unitária
+    float period;                 // Duração de uma volta, em segundos
+    float bound;                  // Maior distância da curva até a origem
+};
+
+// Número de formatos disponíveis e a tabela de cada um. As tabelas dos
+// formatos embutidos são construídas na primeira chamada. Depois da
+// primeira consulta as tabelas não mudam mais e podem ser lidas por várias
+// threads ao mesmo tempo (veja session.h).
+int Paths_Count();
+const PathTable& Paths_Get(int shape);
+
+// Posição no formato unitário para a fração s (em [0,1)) de uma volta:
+// consulta na tabela e interpolação linear entre as duas amostras vizinhas.
+void Paths_Sample(const PathTable& path, float s, float* x, float* y, float* z);
+
+// Registra um novo formato a partir de uma spline de Catmull-Rom fechada que
+// passa pelos pontos de controle (x,y,z consecutivos). Retorna o índice do
+// novo formato, ou -1 se PATH_MAX_SHAPES já foi atingido. Só pode ser
+// chamada na inicialização, antes de qualquer Paths_Count() ou Paths_Get()
+// (verificado por um assert; sem asserts retorna -1): as tabelas são
+// enviadas uma única vez para a GPU (veja LoadPathTableTexture() em
+// main.cpp), sem trava, e um formato registrado depois seria testado pelo
+// tiro na CPU mas desenhado errado.
+int Paths_AddCatmullRom(const std::vector<float>& control_points);
+
+#endif // _PATHS_H
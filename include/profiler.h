@@ -0,0 +1,67 @@
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include <stdint.h>
+
+// Perfil da CPU com marcadores de escopo. PROFILE_SCOPE("nome") mede o
+// tempo entre a declaração e o fim do bloco e guarda o intervalo em um anel
+// da própria thread, sem trava: só a thread dona escreve no seu anel, e cada
+// anel guarda os PROFILER_RING_EVENTS intervalos mais recentes. Os anéis de
+// todas as threads podem ser exportados no formato de trace do Chrome
+// (chrome://tracing ou https://ui.perfetto.dev), onde os picos de tempo de
+// quadro e as demoras no carregamento aparecem em uma linha do tempo.
+//
+// Os marcadores existem nas builds de depuração (sem NDEBUG) e nas que
+// definem ENABLE_PROFILER (opção ENABLE_PROFILER do CMakeLists.txt); nas
+// demais as macros abaixo não geram código algum.
+
+#if defined(ENABLE_PROFILER) || !defined(NDEBUG)
+#define PROFILER_ENABLED 1
+#endif
+
+// Capacidade do anel de cada thread (potência de 2).
+#define PROFILER_RING_EVENTS 65536
+
+// Nanossegundos desde o início do programa.
+uint64_t Profiler_Now();
+
+// Guarda um intervalo no anel da thread atual. "name" precisa existir até a
+// exportação (normalmente um literal).
+void Profiler_Record(const char* name, uint64_t begin_ns, uint64_t end_ns);
+
+// Nome da thread atual na linha do tempo (ex: "principal").
+void Profiler_SetThreadName(const char* name);
+
+// Grava os intervalos guardados no arquivo JSON. Retorna false (imprimindo o
+// motivo) em caso de erro ou se os marcadores não foram compilados.
+bool Profiler_ExportChromeTrace(const char* path);
+
+#ifdef PROFILER_ENABLED
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) : m_Name(name), m_Begin(Profiler_Now()) {}
+    ~ProfileScope() { Profiler_Record(m_Name, m_Begin, Profiler_Now()); }
+
+private:
+    ProfileScope(const ProfileScope&);
+    ProfileScope& operator=(const ProfileScope&);
+
+    const char* m_Name;
+    uint64_t m_Begin;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_THREAD_NAME(name) Profiler_SetThreadName(name)
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_THREAD_NAME(name) ((void)0)
+
+#endif // PROFILER_ENABLED
+
+#endif // _PROFILER_H
@@ -0,0 +1,109 @@
+#ifndef _RAYCAST_H
+#define _RAYCAST_H
+
+#include <cstddef>
+#include <vector>
+
+// Conjunto de esferas armazenado como "structure of arrays" (SoA): cada
+// coordenada fica em um vetor contíguo próprio, o que permite que os kernels
+// SIMD abaixo carreguem 4 (SSE) ou 8 (AVX2) esferas com uma única instrução.
+struct SphereSet
+{
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> radius;
+
+    void Clear()
+    {
+        center_x.clear();
+        center_y.clear();
+        center_z.clear();
+        radius.clear();
+    }
+
+    void Add(float x, float y, float z, float r)
+    {
+        center_x.push_back(x);
+        center_y.push_back(y);
+        center_z.push_back(z);
+        radius.push_back(r);
+    }
+
+    size_t Size() const { return radius.size(); }
+};
+
+// Pacote de raios, também em formato SoA. As direções devem estar
+// normalizadas, para que a distância retornada seja em unidades do mundo.
+struct RayPacket
+{
+    std::vector<float> origin_x;
+    std::vector<float> origin_y;
+    std::vector<float> origin_z;
+    std::vector<float> dir_x;
+    std::vector<float> dir_y;
+    std::vector<float> dir_z;
+
+    void Clear()
+    {
+        origin_x.clear();
+        origin_y.clear();
+        origin_z.clear();
+        dir_x.clear();
+        dir_y.clear();
+        dir_z.clear();
+    }
+
+    void Add(float ox, float oy, float oz, float dx, float dy, float dz)
+    {
+        origin_x.push_back(ox);
+        origin_y.push_back(oy);
+        origin_z.push_back(oz);
+        dir_x.push_back(dx);
+        dir_y.push_back(dy);
+        dir_z.push_back(dz);
+    }
+
+    size_t Size() const { return dir_x.size(); }
+};
+
+// Resultado da interseção de um raio: índice da esfera mais próxima atingida
+// (-1 caso nenhuma seja atingida) e a distância ao longo do raio.
+struct RayHit
+{
+    int   index;
+    float distance;
+};
+
+// Implementações disponíveis do kernel. A melhor suportada pela CPU é
+// escolhida em tempo de execução na primeira chamada.
+enum RayCastKernel
+{
+    RAYCAST_KERNEL_SCALAR = 0,
+    RAYCAST_KERNEL_SSE    = 1,
+    RAYCAST_KERNEL_AVX2   = 2
+};
+
+// Calcula, para cada raio do pacote, a esfera mais próxima atingida. O vetor
+// "hits" deve ter espaço para rays.Size() elementos. Empates de distância são
+// resolvidos pelo menor índice, de forma que todos os kernels retornam o
+// mesmo resultado.
+void RayCast_NearestHits(const RayPacket& rays, const SphereSet& spheres, RayHit* hits);
+
+// O mesmo, só com as esferas [begin, end). Os índices retornados continuam
+// sendo os do conjunto inteiro. Permite dividir um conjunto grande entre
+// várias threads (veja TargetSystem_RayCast()).
+void RayCast_NearestHitsRange(const RayPacket& rays, const SphereSet& spheres, size_t begin, size_t end,
+                              RayHit* hits);
+
+// Kernel em uso e o melhor kernel suportado pela CPU atual.
+RayCastKernel RayCast_ActiveKernel();
+RayCastKernel RayCast_BestSupportedKernel();
+
+// Força o uso de um kernel específico (utilizado pelo microbenchmark).
+// Retorna false se a CPU não suporta o kernel pedido.
+bool RayCast_SetKernel(RayCastKernel kernel);
+
+const char* RayCast_KernelName(RayCastKernel kernel);
+
+#endif // _RAYCAST_H
@@ -0,0 +1,49 @@
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <stdint.h>
+#include <vector>
+
+// Gravação e reprodução de sessões. A simulação avança em passos fixos (veja
+// main.cpp), então uma sessão fica determinada pela semente (veja rng.h) e
+// pelos eventos de entrada, cada um associado ao passo a partir do qual ele
+// vale. Reproduzir os mesmos eventos nos mesmos passos leva ao mesmo estado
+// do jogo, o que permite comparar o desempenho de builds diferentes sobre
+// exatamente a mesma sessão.
+
+enum InputEventType
+{
+    INPUT_EVENT_KEY,          // KeyCallback(): code = tecla
+    INPUT_EVENT_CURSOR,       // CursorPosCallback(): x, y
+    INPUT_EVENT_MOUSE_BUTTON  // MouseButtonCallback(): code = botão; x, y = cursor no momento do clique
+};
+
+// Evento de entrada. No arquivo, cada campo é gravado separadamente (veja
+// replay.cpp).
+struct InputEvent
+{
+    double x, y;       // Posição do cursor
+    uint32_t step;     // Passo da simulação a partir do qual o evento vale
+    float time;        // Instante do evento, em segundos desde o início da sessão
+    int32_t code;      // Tecla ou botão
+    int32_t scancode;
+    uint8_t type;      // InputEventType
+    uint8_t action;    // GLFW_PRESS, GLFW_RELEASE ou GLFW_REPEAT
+    uint16_t mods;
+};
+
+struct InputLog
+{
+    uint64_t seed;               // Semente da sessão
+    double step;                 // Duração de um passo da simulação, em segundos
+    std::vector<InputEvent> events;
+    uint32_t total_steps;        // Passos simulados na sessão
+    uint64_t final_state_hash;   // Simulation_StateHash() ao fim da sessão
+};
+
+// Grava e lê o arquivo binário da sessão. Retornam false (imprimindo o
+// motivo) em caso de erro.
+bool InputLog_Save(const InputLog& log, const char* path);
+bool InputLog_Load(InputLog* log, const char* path);
+
+#endif // _REPLAY_H
@@ -0,0 +1,60 @@
+#ifndef _RNG_H
+#define _RNG_H
+
+#include <cstddef>
+#include <stdint.h>
+
+// Gerador PCG32 (XSH RR, veja https://www.pcg-random.org/). Cada gerador é
+// definido por uma semente e por um número de sequência: geradores com a
+// mesma semente e sequências diferentes produzem fluxos independentes.
+struct Rng
+{
+    uint64_t state;
+    uint64_t increment;
+
+    Rng() { Seed(0, 0); }
+    Rng(uint64_t seed, uint64_t sequence) { Seed(seed, sequence); }
+
+    void Seed(uint64_t seed, uint64_t sequence);
+
+    // Próximo inteiro de 32 bits.
+    uint32_t NextU32();
+
+    // Float uniforme em [0,1).
+    float NextFloat() { return (NextU32() >> 8) * (1.0f / 16777216.0f); }
+
+    // Inteiro uniforme em [0,n), sem viés.
+    uint32_t NextBelow(uint32_t n);
+
+    // Preenche "out" com "count" floats uniformes em [0,1). Equivalente a
+    // chamar NextFloat() "count" vezes, mas sem a chamada por número.
+    void FillFloats(float* out, size_t count);
+};
+
+// Fluxos independentes, um por subsistema, para que o número de valores
+// sorteados por um subsistema não altere os valores de outro (ex: sortear
+// um formato de trajetória a mais não muda as posições dos próximos alvos).
+enum RngStream
+{
+    RNG_STREAM_SPAWN_POSITION, // Posições dos alvos criados
+    RNG_STREAM_SPAWN_TIMING,   // Intervalos entre as criações de alvos
+    RNG_STREAM_LIFETIME,       // Tempo de vida dos alvos
+    RNG_STREAM_PATH,           // Formato de trajetória dos alvos em movimento
+    RNG_NUM_STREAMS
+};
+
+// Semeia os RNG_NUM_STREAMS fluxos de "streams" com a semente "seed". Cada
+// simulação tem os seus fluxos (veja Simulation::rng); uma mesma semente
+// reproduz a mesma sequência de alvos.
+void Rng_SeedStreams(Rng* streams, uint64_t seed);
+
+// Semente da sessão do programa (--seed), usada pela simulação do jogo, do
+// modo headless e do teste de carga.
+void Rng_SetSessionSeed(uint64_t seed);
+uint64_t Rng_SessionSeed();
+
+// Semente derivada do relógio e de std::random_device, para sessões em que
+// nenhuma semente foi informada.
+uint64_t Rng_RandomSeed();
+
+#endif // _RNG_H
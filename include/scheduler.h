@@ -0,0 +1,57 @@
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+// Eventos de jogo agendados no tempo de simulação (segundos, mesmo relógio
+// de glfwGetTime()).
+enum GameEventType
+{
+    EVENT_SPAWN_TARGET,        // Cria um alvo parado (payload: rodada)
+    EVENT_SPAWN_MOVING_TARGET, // Cria um alvo em movimento (payload: rodada)
+    EVENT_TARGET_EXPIRED,      // Fim do tempo de vida de um alvo (payload: id do alvo)
+    EVENT_ROUND_END,           // Fim dos 60 segundos da rodada (payload: rodada)
+    EVENT_SHOT_READY           // Fim do intervalo entre dois tiros
+};
+
+struct GameEvent
+{
+    double time;
+    int type;
+    int payload;
+    uint64_t sequence; // Ordem de agendamento, para desempatar eventos no mesmo instante
+};
+
+// Fila de prioridade (min-heap) de eventos ordenados pelo instante em que
+// devem ocorrer. A cada quadro, o laço principal retira somente os eventos
+// vencidos, então o custo de um quadro sem eventos é O(1), independente do
+// número de alvos.
+//
+// Não há cancelamento: eventos que perderam o sentido (ex: criação de alvo
+// de uma rodada já reiniciada) carregam no payload a informação necessária
+// para serem ignorados quando retirados da fila.
+class EventScheduler
+{
+public:
+    EventScheduler() : next_sequence_(0) {}
+
+    void Schedule(double time, int type, int payload = 0);
+
+    // Retira o próximo evento com instante <= now. Retorna false se não há
+    // evento vencido.
+    bool PopDue(double now, GameEvent* event);
+
+    // Instante do próximo evento, ou infinito se a fila está vazia.
+    double NextTime() const;
+
+    size_t Size() const { return heap_.size(); }
+    void Clear() { heap_.clear(); }
+
+private:
+    std::vector<GameEvent> heap_;
+    uint64_t next_sequence_;
+};
+
+#endif // _SCHEDULER_H
@@ -0,0 +1,50 @@
+#ifndef _SESSION_H
+#define _SESSION_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "simulation.h"
+
+// Várias sessões de jogo independentes no mesmo processo, para pontuação e
+// avaliação de jogadores automáticos em lote. Cada GameSession tem a sua
+// simulação, com os seus fluxos aleatórios e a sua memória de trabalho, e
+// avança sem janela com o jogador automático do modo headless; sessões
+// diferentes não compartilham estado mutável e podem avançar ao mesmo tempo
+// em threads diferentes.
+
+struct GameSession
+{
+    Simulation sim;
+    uint64_t seed; // Semente dos fluxos aleatórios da simulação
+    double step;   // Passo fixo, em segundos
+    long steps;    // Passos já executados
+
+    // Duração de cada passo executado, em milissegundos.
+    std::vector<float> step_ms;
+};
+
+// Cria a simulação da sessão com a semente "seed" e o passo "step".
+void GameSession_Init(GameSession& session, uint64_t seed, double step);
+
+// Executa "count" passos e mede a duração de cada um.
+void GameSession_Step(GameSession& session, long count);
+
+struct SessionHostOptions
+{
+    int sessions;   // Número de sessões
+    double seconds; // Tempo simulado por sessão
+    double step;    // Passo da simulação, em segundos
+    uint64_t seed;  // A sessão i usa a semente seed + i
+
+    SessionHostOptions()
+        : sessions(256), seconds(60.0), step(1.0 / 60.0), seed(0) {}
+};
+
+// Executa as sessões em paralelo no sistema de tarefas (veja jobs.h), uma
+// tarefa por sessão, e imprime sessões e passos por segundo, a distribuição
+// da duração dos passos e das sessões e um resumo do estado final de todas
+// as sessões, que não depende do número de threads.
+void SessionHost_Run(const SessionHostOptions& options);
+
+#endif // _SESSION_H
@@ -0,0 +1,209 @@
+#ifndef _SIMULATION_H
+#define _SIMULATION_H
+
+#include <stdint.h>
+#include <vector>
+
+#include <glm/vec4.hpp>
+
+#include "classes.h"
+#include "ecs.h"
+#include "motion.h"
+#include "raycast.h"
+#include "rng.h"
+#include "scheduler.h"
+
+// Simulação do jogo: alvos, criação de alvos, colisões, física do jogador e
+// pontuação. Não depende de OpenGL nem de GLFW, para poder ser executada sem
+// janela (veja Simulation_RunHeadless()); main.cpp apenas a desenha. Todo o
+// estado fica em Simulation, então várias simulações podem avançar ao mesmo
+// tempo em threads diferentes (veja session.h).
+
+// Identificadores dos objetos, enviados ao fragment shader como "object_id"
+// (veja "shader_fragment-tarefa1.glsl") e guardados no componente Renderable.
+#define SPHERE 0
+#define SPHERE_PARADA 1
+#define PLANE  2
+#define GUN 3
+#define PLANE_PAREDE 4
+#define MARIO 5
+
+const double ROUND_DURATION = 60.0; // Duração de uma rodada, em segundos
+const double SHOT_COOLDOWN = 0.5;   // Intervalo mínimo entre dois tiros
+const double SHOT_REWIND_MAX = 0.1; // Máximo que um tiro volta no tempo (veja Simulation_FireAt())
+
+// Alvos guardados em Simulation::spawn_history.
+const int SPAWN_HISTORY_SIZE = 16;
+
+// Clique registrado pelo callback do mouse, com o instante e a direção da
+// câmera no momento do clique, e não no passo da simulação que o processa.
+struct ShotInput
+{
+    double time;         // Instante do clique, no relógio da simulação
+    glm::vec4 direction; // Direção normalizada do tiro
+};
+
+// Comandos do jogador em um quadro.
+struct PlayerInput
+{
+    bool forward, backward, left, right; // Teclas W, S, A e D
+    bool walk;                           // Shift: anda com metade da velocidade
+    bool jump;                           // Espaço
+    bool restart;                        // R: reinicia a rodada
+    bool fire;                           // Botão esquerdo do mouse (segurado)
+    float camera_theta, camera_phi;      // Ângulos da câmera (veja CursorPosCallback())
+
+    // Raio do tiro: origem e direção normalizada. Na câmera em terceira
+    // pessoa a origem não é a posição do jogador. Os cliques com o seu
+    // próprio instante são disparados antes, por Simulation_FireShots().
+    glm::vec4 aim_origin;
+    glm::vec4 aim_direction;
+
+    PlayerInput()
+        : forward(false), backward(false), left(false), right(false),
+          walk(false), jump(false), restart(false), fire(false),
+          camera_theta(0.0f), camera_phi(0.0f),
+          aim_origin(0.0f, 0.0f, 0.0f, 1.0f), aim_direction(0.0f, 0.0f, -1.0f, 0.0f) {}
+};
+
+// Alvo criado no instante "time". Veja Simulation::spawn_history.
+struct SpawnRecord
+{
+    EntityId entity;
+    double time;
+};
+
+struct Simulation
+{
+    World world;          // Alvos e objetos do mapa
+    MotionPool motion;    // Trajetórias dos alvos em movimento
+    EventScheduler scheduler;
+    Player player;
+    Rng rng[RNG_NUM_STREAMS]; // Fluxos aleatórios (veja RngStream)
+
+    // O jogador é a câmera em primeira pessoa.
+    glm::vec4 camera_position;
+    glm::vec4 camera_velocity;
+    glm::vec4 camera_view_vector;
+    glm::vec4 camera_up_vector;
+
+    int round;               // Rodada atual; eventos de rodadas anteriores são ignorados
+    double round_start_time; // Início da rodada atual
+    bool round_over;         // A rodada acabou e nenhum alvo é criado até reiniciar
+    bool shot_ready;         // false até o evento EVENT_SHOT_READY após um tiro
+    int countdown;           // Segundos restantes, mostrados na tela
+    bool print_hits;         // Imprime a vida restante dos alvos atingidos
+
+    // Últimos alvos criados, em anel: um tiro voltado a um instante anterior
+    // ignora os alvos que ainda não existiam. Os alvos removidos depois do
+    // clique não precisam de histórico, pois Simulation_FireShots() dispara
+    // antes de processar os eventos posteriores ao clique. Os alvos em
+    // movimento são avaliados no instante do tiro (motion.h); os parados
+    // ficam na posição do passo atual, que só muda quando são empurrados
+    // (veja CollisionSystem_SeparateTargets()).
+    SpawnRecord spawn_history[SPAWN_HISTORY_SIZE];
+    int spawn_history_next;
+
+    uint64_t snapshots; // Simulation_TakeSnapshot() já feitos
+
+    // Contadores para os relatórios do modo headless.
+    unsigned long spawned;
+    unsigned long shots;
+    unsigned long kills;
+    unsigned long points; // Soma dos pontos de todas as rodadas
+
+    // Memória reaproveitada entre os tiros (veja Simulation_FireAt()).
+    RayPacket shot_rays;
+    SphereSet shot_spheres;
+    std::vector<EntityId> shot_entities;
+    std::vector<RayHit> shot_hits;
+};
+
+// Cópia imutável do que é desenhado em um quadro: alvos, mapa, câmera e
+// HUD. Permite desenhar em uma thread enquanto outra avança a simulação
+// (veja triple_buffer.h).
+struct SimulationSnapshot
+{
+    World world;
+    // Em motion.dirty_slots, os slots alterados desde o snapshot anterior.
+    MotionPool motion;
+
+    glm::vec4 camera_position;
+    glm::vec4 camera_view_vector;
+    glm::vec4 camera_up_vector;
+
+    int score;
+    int countdown;
+    bool round_over;
+
+    double time;       // Instante da simulação
+    uint64_t sequence; // 1 no primeiro snapshot, e assim por diante
+
+    SimulationSnapshot()
+        : score(0), countdown(0), round_over(false), time(0.0), sequence(0) {}
+};
+
+// Cria o mapa, posiciona o jogador e inicia a primeira rodada no instante
+// "now" (segundos, no mesmo relógio das demais chamadas). Os fluxos
+// aleatórios são semeados com "seed"; uma mesma semente reproduz a mesma
+// sequência de alvos.
+void Simulation_Init(Simulation& sim, double now, uint64_t seed);
+
+// Inicia uma nova rodada: agenda seu fim e as primeiras criações de alvos.
+void Simulation_StartRound(Simulation& sim, double now);
+
+// Processa os eventos vencidos (criação e remoção de alvos, fim da rodada,
+// fim do intervalo entre tiros) e as colisões entre o jogador e os alvos.
+void Simulation_UpdateWorld(Simulation& sim, double now);
+
+// Dispara os cliques "shots" (instantes <= now, em ordem) a partir de
+// "origin". Antes de cada tiro são processados os eventos até o instante do
+// clique, e só eles: um alvo que expira entre o clique e "now" ainda estava
+// na tela quando o jogador atirou. Deve ser chamada antes de
+// Simulation_UpdateWorld() no mesmo passo.
+void Simulation_FireShots(Simulation& sim, const glm::vec4& origin, const ShotInput* shots, size_t count, double now);
+
+// Aplica os comandos do jogador: movimento, pulo, gravidade, tiro contínuo
+// e reinício da rodada. "delta_t" é o tempo desde o último quadro.
+void Simulation_UpdatePlayer(Simulation& sim, const PlayerInput& input, double now, float delta_t);
+
+// Vetor "view" (w = 0) da câmera com os ângulos "theta" e "phi" de
+// PlayerInput.
+glm::vec4 Simulation_ViewVector(float theta, float phi);
+
+// Cria um alvo parado ou em movimento ("moving") em uma posição aleatória
+// do mapa, que expira em "lifetime" segundos. Com lifetime <= 0 o alvo não
+// expira.
+EntityId Simulation_SpawnTarget(Simulation& sim, double now, bool moving, double lifetime);
+
+// Dispara um tiro ao longo do raio (origin, direction) no instante "now".
+void Simulation_Fire(Simulation& sim, const glm::vec4& origin, const glm::vec4& direction, double now);
+
+// Dispara no passo "now" um tiro feito no instante "shot_time": os alvos em
+// movimento são avaliados em shot_time e os criados depois dele são
+// ignorados. shot_time é limitado a [now - SHOT_REWIND_MAX, now].
+void Simulation_FireAt(Simulation& sim, const glm::vec4& origin, const glm::vec4& direction,
+                       double shot_time, double now);
+
+// Copia o estado de "sim" no instante "now" para "out", reaproveitando a
+// memória de um snapshot anterior. Os slots alterados da MotionPool passam
+// da simulação para o snapshot.
+void Simulation_TakeSnapshot(Simulation& sim, double now, SimulationSnapshot* out);
+
+// Resumo (FNV-1a) do estado do jogo: rodada, pontuação, jogador e alvos.
+// Duas execuções com a mesma semente e as mesmas entradas nos mesmos passos
+// devem terminar com o mesmo valor (veja replay.h).
+uint64_t Simulation_StateHash(const Simulation& sim);
+
+// Avança a simulação até "now" com o jogador automático do modo headless
+// (veja Simulation_RunHeadless()); "step" é o tempo desde o passo anterior.
+void Simulation_StepHeadless(Simulation& sim, double now, double step);
+
+// Executa "seconds" segundos de simulação com passo fixo "step", sem janela
+// nem OpenGL, o mais rápido possível, e imprime passos por segundo. Um
+// jogador automático anda até o alvo mais próximo, atira sempre que pode e
+// reinicia a rodada quando ela acaba. A semente da sessão (veja rng.h) deve
+// ser definida antes.
+void Simulation_RunHeadless(double seconds, double step);
+
+#endif // _SIMULATION_H
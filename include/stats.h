@@ -0,0 +1,21 @@
+#ifndef _STATS_H
+#define _STATS_H
+
+#include <vector>
+
+// Resumo de amostras de tempo (quadros, passos, sessões) para os relatórios
+// impressos ao fim da execução.
+
+// Percentil p (entre 0 e 1) de um vetor ordenado, pelo método do valor mais
+// próximo. Retorna 0 se o vetor estiver vazio.
+double Stats_Percentile(const std::vector<double>& sorted, double p);
+
+// Imprime média, mediana, percentis 95 e 99 e máximo de "values", na
+// unidade "unit", identificados por "label" (ex: "Passo", "µs").
+void Stats_Print(const char* label, const char* unit, std::vector<double> values);
+
+// O mesmo para tempos de quadro em milissegundos (ex: "Tempo de GPU"),
+// precedido do número de quadros.
+void Stats_PrintFrames(const char* label, const std::vector<double>& frame_ms);
+
+#endif // _STATS_H
@@ -0,0 +1,50 @@
+#ifndef _STRESS_H
+#define _STRESS_H
+
+#include <vector>
+
+#include "simulation.h"
+
+// Teste de carga: cria populações crescentes de alvos parados e em
+// movimento e mede, para cada população, o tempo médio de cada etapa do
+// quadro. O resultado é uma curva de escala em CSV, uma linha por população.
+
+struct StressOptions
+{
+    std::vector<int> populations; // Tamanhos das populações, em ordem crescente
+    float moving_fraction;        // Fração dos alvos que se movem, em [0,1]
+    int spawn_rate;               // Alvos criados por quadro até atingir a população
+    int frames;                   // Quadros medidos por população
+    double max_seconds;           // Tempo máximo de medição por população (mínimo de um quadro)
+    double step;                  // Passo da simulação, em segundos
+    const char* csv_path;         // Arquivo CSV de saída; NULL para não gravar
+
+    StressOptions()
+        : moving_fraction(0.5f), spawn_rate(1000), frames(120), max_seconds(10.0),
+          step(1.0 / 60.0), csv_path("stress.csv") {}
+};
+
+// Tempo médio por quadro de cada etapa, em milissegundos.
+struct StressPhaseTimes
+{
+    double motion;     // Avaliação das trajetórias na CPU (MotionSystem_Sync())
+    double collision;  // Colisão da câmera com os alvos
+    double separation; // Separação dos alvos sobrepostos
+    double hit_test;   // Raycast do tiro contra todos os alvos
+    double render;     // Envio dos comandos de desenho (só com janela)
+};
+
+// Desenha um quadro da simulação. Chamada pelo teste de carga para medir o
+// envio dos comandos de desenho; "user" é repassado sem alteração.
+typedef void (*StressRenderFunction)(Simulation& sim, double now, void* user);
+
+// Lê uma lista de populações separadas por vírgula (ex: "1000,10000").
+// Retorna false se a lista for inválida.
+bool Stress_ParsePopulations(const char* list, std::vector<int>* populations);
+
+// Executa o teste de carga, imprimindo uma tabela no terminal e gravando o
+// CSV. Sem "render" (NULL) a etapa de desenho não é medida. A semente da
+// sessão (veja rng.h) deve ser definida antes.
+void Stress_Run(const StressOptions& options, StressRenderFunction render, void* user);
+
+#endif // _STRESS_H
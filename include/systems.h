@@ -0,0 +1,54 @@
+#ifndef _SYSTEMS_H
+#define _SYSTEMS_H
+
+#include <vector>
+
+#include <glm/vec4.hpp>
+
+#include "ecs.h"
+#include "motion.h"
+#include "raycast.h"
+
+// Arquétipos das entidades do jogo. Um novo tipo de alvo é só uma nova
+// combinação de componentes; os sistemas abaixo o processam sem alterações.
+const ComponentMask ARCHETYPE_STATIC_TARGET =
+    COMPONENT_TRANSFORM | COMPONENT_HEALTH | COMPONENT_LIFETIME | COMPONENT_RENDERABLE | COMPONENT_COLLIDER;
+// Os alvos em movimento não possuem Renderable: eles são desenhados pela GPU
+// a partir da MotionPool (veja DrawMovingTargets() em main.cpp).
+const ComponentMask ARCHETYPE_MOVING_TARGET =
+    COMPONENT_TRANSFORM | COMPONENT_MOTION | COMPONENT_HEALTH | COMPONENT_LIFETIME | COMPONENT_COLLIDER;
+const ComponentMask ARCHETYPE_MAP_OBJECT =
+    COMPONENT_STATIC_MODEL | COMPONENT_RENDERABLE;
+
+// Componentes que tornam uma entidade um alvo: algo que pode ser atingido.
+const ComponentMask TARGET_COMPONENTS = COMPONENT_TRANSFORM | COMPONENT_HEALTH | COMPONENT_COLLIDER;
+
+// Sistema de movimento: avalia a trajetória de todas as entidades com
+// Motion no instante "now" e copia as posições para os seus Transforms.
+void MotionSystem_Sync(World& world, MotionPool& motion, float now);
+
+// Sistema de colisão: afasta a câmera (esfera de raio "camera_radius") dos
+// alvos e separa os alvos parados que se sobrepõem a outros alvos. A
+// posição dos alvos em movimento só é avaliada quando a trajetória pode
+// passar perto da câmera ou de outro alvo.
+void CollisionSystem_Update(World& world, const MotionPool& motion, float now, glm::vec4* camera, float camera_radius);
+
+// As duas etapas de CollisionSystem_Update(), separadas para medição (veja
+// stress.h): afastar a câmera dos alvos e separar os alvos sobrepostos.
+void CollisionSystem_PushCamera(World& world, const MotionPool& motion, float now, glm::vec4* camera, float camera_radius);
+void CollisionSystem_SeparateTargets(World& world, const MotionPool& motion, float now);
+
+// Monta o conjunto de esferas dos alvos para o raycast do tiro.
+// "sphere_to_entity[i]" recebe a entidade da esfera i. Os Transforms devem
+// estar atualizados (veja MotionSystem_Sync()).
+void TargetSystem_GatherSpheres(const World& world, SphereSet* spheres, std::vector<EntityId>* sphere_to_entity);
+
+// RayCast_NearestHits() com as esferas divididas entre as threads do
+// sistema de tarefas (veja jobs.h). O resultado é o mesmo.
+void TargetSystem_RayCast(const RayPacket& rays, const SphereSet& spheres, RayHit* hits);
+
+// Remove um alvo (destruído ou expirado), liberando o slot de sua
+// trajetória na MotionPool, se houver.
+void TargetSystem_Destroy(World& world, MotionPool& motion, EntityId id);
+
+#endif // _SYSTEMS_H
@@ -0,0 +1,58 @@
+#ifndef _TRIPLE_BUFFER_H
+#define _TRIPLE_BUFFER_H
+
+#include <atomic>
+
+// Três cópias de um valor passadas de uma thread produtora para uma thread
+// consumidora sem trava. A produtora escreve em WriteBuffer() e a publica
+// com Publish(); a consumidora pega a última publicação com Update() e a lê
+// em ReadBuffer(). Cada thread tem a sua cópia exclusiva, e a terceira fica
+// no meio, trocada com uma operação atômica: nenhuma das duas espera a
+// outra, e a consumidora sempre vê a publicação mais recente, mesmo que
+// algumas sejam puladas.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : back_(0), middle_(1), front_(2) {}
+
+    // Cópia da produtora.
+    T& WriteBuffer() { return buffers_[back_]; }
+
+    // Publica a cópia da produtora, que passa a escrever na do meio.
+    // Retorna true se a publicação anterior não chegou a ser lida.
+    bool Publish()
+    {
+        int old = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+        back_ = old & INDEX_MASK;
+        return (old & FRESH) != 0;
+    }
+
+    // Pega a última publicação, se houver uma nova. Retorna false se
+    // ReadBuffer() continua a mesma.
+    bool Update()
+    {
+        if ((middle_.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        int old = middle_.exchange(front_, std::memory_order_acq_rel);
+        front_ = old & INDEX_MASK;
+        return true;
+    }
+
+    // Cópia da consumidora.
+    T& ReadBuffer() { return buffers_[front_]; }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4; // A cópia do meio ainda não foi lida
+
+    TripleBuffer(const TripleBuffer&);
+    TripleBuffer& operator=(const TripleBuffer&);
+
+    T buffers_[3];
+    int back_;                 // Só a produtora usa
+    std::atomic<int> middle_;  // Índice e FRESH
+    int front_;                // Só a consumidora usa
+};
+
+#endif // _TRIPLE_BUFFER_H
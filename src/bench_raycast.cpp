@@ -0,0 +1,172 @@
+// Microbenchmark do teste de tiro: compara o caminho original (IsTargetHit()
+// chamado para cada alvo, como era feito em HandleMouseClick()) com os
+// kernels SoA escalar, SSE e AVX2 de raycast.cpp. Reporta raios×esferas por
+// segundo para vários tamanhos de conjunto de alvos.
+//
+// Uso: ./bench_raycast [numero_de_raios]
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include "matrices.h"
+#include "raycast.h"
+
+// Alvo e teste de tiro do caminho original, antes do ECS e de raycast.cpp;
+// ficam aqui só como referência do benchmark.
+struct BenchTarget
+{
+    float x, y, z; // Posição no mundo
+    float radius;
+};
+
+// Projeta o centro do alvo e compara a distância ao centro da tela, em NDC,
+// com o raio do alvo dividido por w.
+static bool IsTargetHit(const BenchTarget& target, const glm::mat4& view, const glm::mat4& projection)
+{
+    glm::vec4 clipSpacePos = projection * view * glm::vec4(target.x, target.y, target.z, 1.0f);
+    glm::vec3 ndcSpacePos = glm::vec3(clipSpacePos) / clipSpacePos.w;
+    float distance = std::sqrt(ndcSpacePos.x * ndcSpacePos.x + ndcSpacePos.y * ndcSpacePos.y);
+    return distance < target.radius / clipSpacePos.w;
+}
+
+// Gerador simples e determinístico, para que todas as execuções usem a mesma cena.
+static unsigned int g_BenchSeed = 12345u;
+static float BenchRandom(float min, float max)
+{
+    g_BenchSeed = g_BenchSeed * 1664525u + 1013904223u;
+    return min + (max - min) * ((g_BenchSeed >> 8) / 16777216.0f);
+}
+
+typedef std::chrono::steady_clock BenchClock;
+
+static double SecondsSince(BenchClock::time_point start)
+{
+    return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+// Executa o kernel SoA repetidamente por pelo menos min_seconds e retorna
+// raios×esferas por segundo.
+static double BenchKernel(RayCastKernel kernel, const RayPacket& rays, const SphereSet& spheres,
+                          std::vector<RayHit>& hits, double min_seconds)
+{
+    RayCast_SetKernel(kernel);
+    size_t iterations = 0;
+    BenchClock::time_point start = BenchClock::now();
+    double elapsed = 0.0;
+    do
+    {
+        RayCast_NearestHits(rays, spheres, hits.data());
+        ++iterations;
+        elapsed = SecondsSince(start);
+    } while (elapsed < min_seconds);
+
+    return (double)iterations * rays.Size() * spheres.Size() / elapsed;
+}
+
+// Caminho original: para cada raio monta as matrizes da câmera e testa os
+// alvos em ordem com IsTargetHit(), parando no primeiro atingido.
+static double BenchIsTargetHit(const RayPacket& rays, const std::vector<BenchTarget>& targets, double min_seconds)
+{
+    glm::mat4 projection = Matrix_Perspective(3.141592f / 2.5f, 16.0f/9.0f, -0.01f, -30.0f);
+    glm::vec4 up = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+
+    size_t iterations = 0;
+    size_t tests = 0;
+    volatile size_t num_hits = 0;
+    BenchClock::time_point start = BenchClock::now();
+    double elapsed = 0.0;
+    do
+    {
+        for (size_t ray = 0; ray < rays.Size(); ++ray)
+        {
+            glm::vec4 position(rays.origin_x[ray], rays.origin_y[ray], rays.origin_z[ray], 1.0f);
+            glm::vec4 direction(rays.dir_x[ray], rays.dir_y[ray], rays.dir_z[ray], 0.0f);
+            glm::mat4 view = Matrix_Camera_View(position, direction, up);
+
+            for (size_t i = 0; i < targets.size(); ++i)
+            {
+                ++tests;
+                if (IsTargetHit(targets[i], view, projection))
+                {
+                    num_hits = num_hits + 1;
+                    break;
+                }
+            }
+        }
+        ++iterations;
+        elapsed = SecondsSince(start);
+    } while (elapsed < min_seconds);
+
+    // Conta os testes realmente executados (o laço para no primeiro acerto),
+    // para não favorecer o caminho original.
+    return (double)tests / elapsed;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t num_rays = (argc > 1) ? (size_t)std::atoi(argv[1]) : 64;
+    if (num_rays == 0)
+        num_rays = 1;
+
+    const size_t sizes[] = { 16, 256, 4096, 65536 };
+    const double min_seconds = 0.25;
+
+    printf("Kernel selecionado em tempo de execução: %s\n", RayCast_KernelName(RayCast_BestSupportedKernel()));
+    printf("%zu raios por pacote\n\n", num_rays);
+    printf("%8s  %14s  %14s  %14s  %14s\n", "esferas", "IsTargetHit", "escalar", "SSE", "AVX2");
+
+    for (size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); ++s)
+    {
+        size_t num_spheres = sizes[s];
+
+        std::vector<BenchTarget> targets;
+        SphereSet spheres;
+        for (size_t i = 0; i < num_spheres; ++i)
+        {
+            float x = BenchRandom(-6.0f, 6.0f);
+            float y = BenchRandom(1.0f, 4.0f);
+            float z = BenchRandom(-6.0f, 6.0f);
+            BenchTarget target = { x, y, z, 0.5f };
+            targets.push_back(target);
+            spheres.Add(x, y, z, target.radius);
+        }
+
+        RayPacket rays;
+        for (size_t i = 0; i < num_rays; ++i)
+        {
+            glm::vec4 d(BenchRandom(-1.0f, 1.0f), BenchRandom(-0.5f, 0.5f), BenchRandom(-1.0f, 1.0f), 0.0f);
+            d /= norm(d);
+            rays.Add(BenchRandom(-6.0f, 6.0f), 0.5f, BenchRandom(-6.0f, 6.0f), d.x, d.y, d.z);
+        }
+
+        std::vector<RayHit> reference(num_rays);
+        std::vector<RayHit> hits(num_rays);
+
+        double rate_original = BenchIsTargetHit(rays, targets, min_seconds);
+        double rate[3] = { 0.0, 0.0, 0.0 };
+        for (int k = RAYCAST_KERNEL_SCALAR; k <= RAYCAST_KERNEL_AVX2; ++k)
+        {
+            RayCastKernel kernel = static_cast<RayCastKernel>(k);
+            if (kernel > RayCast_BestSupportedKernel())
+                continue;
+            rate[k] = BenchKernel(kernel, rays, spheres, hits, min_seconds);
+
+            // Todos os kernels devem concordar com o escalar.
+            if (kernel == RAYCAST_KERNEL_SCALAR)
+                reference = hits;
+            for (size_t i = 0; i < num_rays; ++i)
+                if (hits[i].index != reference[i].index)
+                    fprintf(stderr, "ERRO: kernel %s diverge do escalar no raio %zu.\n", RayCast_KernelName(kernel), i);
+        }
+
+        printf("%8zu  %14.3e  %14.3e  %14.3e  %14.3e\n", num_spheres, rate_original, rate[0], rate[1], rate[2]);
+    }
+
+    RayCast_SetKernel(RayCast_BestSupportedKernel());
+    return 0;
+}
@@ -0,0 +1,426 @@
+// Captura assíncrona de quadros. Veja capture.h.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include "capture.h"
+#include "profiler.h"
+#include "gl_debug.h"
+
+// Número de pixel buffers: um quadro é lido pela CPU CAPTURE_RING quadros
+// depois de ser copiado, quando a GPU normalmente já terminou a cópia.
+static const int CAPTURE_RING = 3;
+
+// Quadros lidos esperando a thread de gravação. Se ela não der conta, os
+// quadros seguintes são descartados em vez de travar a renderização.
+static const size_t CAPTURE_MAX_QUEUED = 8;
+
+struct CaptureSlot
+{
+    GLuint buffer;
+    size_t size;       // Bytes alocados no buffer
+    bool pending;      // Há uma cópia ainda não lida
+    unsigned int frame;
+    int width, height;
+};
+
+struct CaptureJob
+{
+    std::vector<unsigned char> pixels; // RGBA, linha de baixo primeiro (como glReadPixels)
+    unsigned int frame;
+    int width, height;
+};
+
+static bool g_CaptureStarted = false;
+static CaptureOptions g_CaptureOptions;
+static CaptureSlot g_CaptureRing[CAPTURE_RING];
+static int g_CaptureNextSlot = 0;
+static unsigned int g_CaptureFrame = 0;
+
+static std::thread g_CaptureThread;
+static std::mutex g_CaptureMutex;
+static std::condition_variable g_CaptureWake;
+static std::deque<CaptureJob> g_CaptureQueue;
+static std::vector<std::vector<unsigned char> > g_CaptureFreePixels; // Reaproveitados entre quadros
+static bool g_CaptureStop = false;
+
+// Contadores; os da thread de gravação só são lidos depois do join().
+static unsigned int g_CaptureDropped = 0;
+static unsigned int g_CaptureWritten = 0;
+static unsigned int g_GoldenEqual = 0;
+static unsigned int g_GoldenDifferent = 0;
+static unsigned int g_GoldenMissing = 0;
+
+static std::string FramePath(const char* directory, unsigned int frame, const char* extension)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "frame_%05u.%s", frame, extension);
+    return std::string(directory) + "/" + name;
+}
+
+// ---------------------------------------------------------------------------
+// PNG sem compressão: os dados da imagem vão em blocos "stored" do deflate,
+// o que dispensa uma biblioteca de compressão.
+
+static unsigned int Crc32(const unsigned char* data, size_t size, unsigned int crc)
+{
+    static unsigned int table[256];
+    static bool table_ready = false;
+    if (!table_ready)
+    {
+        for (unsigned int n = 0; n < 256; ++n)
+        {
+            unsigned int c = n;
+            for (int k = 0; k < 8; ++k)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        table_ready = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PutBigEndian32(std::vector<unsigned char>* out, unsigned int value)
+{
+    out->push_back((value >> 24) & 0xFF);
+    out->push_back((value >> 16) & 0xFF);
+    out->push_back((value >> 8) & 0xFF);
+    out->push_back(value & 0xFF);
+}
+
+static bool WriteChunk(FILE* file, const char* type, const std::vector<unsigned char>& data)
+{
+    std::vector<unsigned char> header;
+    PutBigEndian32(&header, (unsigned int)data.size());
+    header.insert(header.end(), type, type + 4);
+    unsigned int crc = Crc32(&header[4], 4, 0);
+    if (!data.empty())
+        crc = Crc32(data.data(), data.size(), crc);
+    std::vector<unsigned char> footer;
+    PutBigEndian32(&footer, crc);
+    return fwrite(header.data(), 1, header.size(), file) == header.size()
+        && (data.empty() || fwrite(data.data(), 1, data.size(), file) == data.size())
+        && fwrite(footer.data(), 1, footer.size(), file) == footer.size();
+}
+
+static bool WritePng(const char* path, const CaptureJob& job, std::vector<unsigned char>* scratch)
+{
+    static const unsigned char PNG_SIGNATURE[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+
+    std::vector<unsigned char> ihdr;
+    PutBigEndian32(&ihdr, job.width);
+    PutBigEndian32(&ihdr, job.height);
+    const unsigned char ihdr_tail[5] = { 8, 6, 0, 0, 0 }; // 8 bits, RGBA, deflate, sem filtro, sem entrelaçamento
+    ihdr.insert(ihdr.end(), ihdr_tail, ihdr_tail + 5);
+
+    // Cada linha, de cima para baixo, é precedida pelo tipo de filtro (0).
+    size_t row_size = 4 * (size_t)job.width;
+    size_t raw_size = (row_size + 1) * job.height;
+    std::vector<unsigned char>& idat = *scratch;
+    idat.clear();
+    idat.reserve(raw_size + raw_size / 65535 * 5 + 16);
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+
+    unsigned int adler_a = 1, adler_b = 0;
+    size_t block_left = 0;
+    size_t remaining = raw_size;
+    for (int y = job.height - 1; y >= 0; --y)
+    {
+        const unsigned char* row = &job.pixels[y * row_size];
+        for (size_t x = 0; x <= row_size; ++x)
+        {
+            if (block_left == 0)
+            {
+                block_left = remaining < 65535 ? remaining : 65535;
+                idat.push_back(remaining == block_left ? 1 : 0);
+                idat.push_back(block_left & 0xFF);
+                idat.push_back((block_left >> 8) & 0xFF);
+                idat.push_back(~block_left & 0xFF);
+                idat.push_back((~block_left >> 8) & 0xFF);
+            }
+            unsigned char byte = (x == 0) ? 0 : row[x - 1];
+            idat.push_back(byte);
+            adler_a = (adler_a + byte) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+            --block_left;
+            --remaining;
+        }
+    }
+    PutBigEndian32(&idat, (adler_b << 16) | adler_a);
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+        return false;
+    bool ok = fwrite(PNG_SIGNATURE, 1, 8, file) == 8
+           && WriteChunk(file, "IHDR", ihdr)
+           && WriteChunk(file, "IDAT", idat)
+           && WriteChunk(file, "IEND", std::vector<unsigned char>());
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+static bool WriteRaw(const char* path, const CaptureJob& job)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+        return false;
+    size_t row_size = 4 * (size_t)job.width;
+    bool ok = true;
+    for (int y = job.height - 1; y >= 0 && ok; --y)
+        ok = fwrite(&job.pixels[y * row_size], 1, row_size, file) == row_size;
+    ok = (fclose(file) == 0) && ok;
+    return ok;
+}
+
+// Compara o quadro com a imagem de referência de mesmo número. O programa
+// sempre carrega imagens com stbi_set_flip_vertically_on_load(true) (veja
+// Capture_Start()), então a referência também chega com a linha de baixo
+// primeiro, como os pixels lidos da GPU.
+static void CompareWithGolden(const CaptureJob& job)
+{
+    std::string path = FramePath(g_CaptureOptions.golden_directory, job.frame, "png");
+    int width, height, channels;
+    unsigned char* golden = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (golden == NULL)
+    {
+        ++g_GoldenMissing;
+        return;
+    }
+
+    if (width != job.width || height != job.height)
+    {
+        printf("Captura: quadro %u tem %dx%d pixels, a referência \"%s\" tem %dx%d\n",
+               job.frame, job.width, job.height, path.c_str(), width, height);
+        ++g_GoldenDifferent;
+        stbi_image_free(golden);
+        return;
+    }
+
+    size_t different = 0;
+    int max_difference = 0;
+    for (size_t p = 0; p < (size_t)width * height; ++p)
+    {
+        int pixel_difference = 0;
+        for (int c = 0; c < 4; ++c)
+        {
+            int d = abs((int)job.pixels[4 * p + c] - (int)golden[4 * p + c]);
+            if (d > pixel_difference)
+                pixel_difference = d;
+        }
+        if (pixel_difference > g_CaptureOptions.tolerance)
+            ++different;
+        if (pixel_difference > max_difference)
+            max_difference = pixel_difference;
+    }
+    stbi_image_free(golden);
+
+    if (different == 0)
+        ++g_GoldenEqual;
+    else
+    {
+        printf("Captura: quadro %u difere da referência em %zu pixels (diferença máxima %d)\n",
+               job.frame, different, max_difference);
+        ++g_GoldenDifferent;
+    }
+}
+
+static void CaptureThread()
+{
+    PROFILE_THREAD_NAME("captura");
+    std::vector<unsigned char> scratch;
+    for (;;)
+    {
+        CaptureJob job;
+        {
+            std::unique_lock<std::mutex> lock(g_CaptureMutex);
+            while (g_CaptureQueue.empty() && !g_CaptureStop)
+                g_CaptureWake.wait(lock);
+            if (g_CaptureQueue.empty())
+                return;
+            job.frame = g_CaptureQueue.front().frame;
+            job.width = g_CaptureQueue.front().width;
+            job.height = g_CaptureQueue.front().height;
+            job.pixels.swap(g_CaptureQueue.front().pixels);
+            g_CaptureQueue.pop_front();
+        }
+
+        PROFILE_SCOPE("gravar quadro");
+        if (g_CaptureOptions.directory != NULL)
+        {
+            bool png = g_CaptureOptions.format == CAPTURE_PNG;
+            std::string path = FramePath(g_CaptureOptions.directory, job.frame, png ? "png" : "raw");
+            if (png ? WritePng(path.c_str(), job, &scratch) : WriteRaw(path.c_str(), job))
+                ++g_CaptureWritten;
+            else
+                fprintf(stderr, "ERRO: não foi possível gravar \"%s\".\n", path.c_str());
+        }
+        if (g_CaptureOptions.golden_directory != NULL)
+            CompareWithGolden(job);
+
+        std::lock_guard<std::mutex> lock(g_CaptureMutex);
+        g_CaptureFreePixels.push_back(std::vector<unsigned char>());
+        g_CaptureFreePixels.back().swap(job.pixels);
+    }
+}
+
+// Lê pela CPU a cópia guardada no buffer e a entrega à thread de gravação.
+static void CollectSlot(CaptureSlot& slot)
+{
+    size_t size = 4 * (size_t)slot.width * slot.height;
+    slot.pending = false;
+
+    std::vector<unsigned char> pixels;
+    {
+        std::lock_guard<std::mutex> lock(g_CaptureMutex);
+        if (g_CaptureQueue.size() >= CAPTURE_MAX_QUEUED)
+        {
+            ++g_CaptureDropped;
+            return;
+        }
+        if (!g_CaptureFreePixels.empty())
+        {
+            pixels.swap(g_CaptureFreePixels.back());
+            g_CaptureFreePixels.pop_back();
+        }
+    }
+    pixels.resize(size);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    if (data != NULL)
+    {
+        memcpy(pixels.data(), data, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (data == NULL)
+    {
+        ++g_CaptureDropped;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_CaptureMutex);
+    g_CaptureQueue.push_back(CaptureJob());
+    g_CaptureQueue.back().pixels.swap(pixels);
+    g_CaptureQueue.back().frame = slot.frame;
+    g_CaptureQueue.back().width = slot.width;
+    g_CaptureQueue.back().height = slot.height;
+    g_CaptureWake.notify_one();
+}
+
+bool Capture_Start(const CaptureOptions& options)
+{
+    if (options.directory == NULL && options.golden_directory == NULL)
+        return false;
+
+    // Testa se o diretório de saída existe e aceita arquivos.
+    if (options.directory != NULL)
+    {
+        std::string probe = std::string(options.directory) + "/.capture";
+        FILE* file = fopen(probe.c_str(), "wb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "ERRO: não foi possível gravar no diretório \"%s\".\n", options.directory);
+            return false;
+        }
+        fclose(file);
+        remove(probe.c_str());
+    }
+
+    g_CaptureOptions = options;
+    if (g_CaptureOptions.every < 1)
+        g_CaptureOptions.every = 1;
+    stbi_set_flip_vertically_on_load(true);
+
+    for (int i = 0; i < CAPTURE_RING; ++i)
+    {
+        glGenBuffers(1, &g_CaptureRing[i].buffer);
+        GL_DEBUG_LABEL(GL_BUFFER, g_CaptureRing[i].buffer, "captura");
+        g_CaptureRing[i].size = 0;
+        g_CaptureRing[i].pending = false;
+    }
+    g_CaptureNextSlot = 0;
+    g_CaptureFrame = 0;
+    g_CaptureStop = false;
+    g_CaptureThread = std::thread(CaptureThread);
+    g_CaptureStarted = true;
+    return true;
+}
+
+void Capture_Frame(int width, int height)
+{
+    if (!g_CaptureStarted)
+        return;
+    PROFILE_SCOPE("captura");
+
+    unsigned int frame = g_CaptureFrame++;
+    if (frame % g_CaptureOptions.every != 0 || width <= 0 || height <= 0)
+        return;
+
+    CaptureSlot& slot = g_CaptureRing[g_CaptureNextSlot];
+    g_CaptureNextSlot = (g_CaptureNextSlot + 1) % CAPTURE_RING;
+    if (slot.pending)
+        CollectSlot(slot);
+
+    size_t size = 4 * (size_t)width * height;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.size < size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        slot.size = size;
+    }
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.pending = true;
+    slot.frame = frame;
+    slot.width = width;
+    slot.height = height;
+}
+
+void Capture_Finish()
+{
+    if (!g_CaptureStarted)
+        return;
+
+    // Os buffers pendentes são lidos do mais antigo para o mais novo.
+    for (int i = 0; i < CAPTURE_RING; ++i)
+    {
+        CaptureSlot& slot = g_CaptureRing[(g_CaptureNextSlot + i) % CAPTURE_RING];
+        if (slot.pending)
+            CollectSlot(slot);
+        glDeleteBuffers(1, &slot.buffer);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_CaptureMutex);
+        g_CaptureStop = true;
+        g_CaptureWake.notify_one();
+    }
+    g_CaptureThread.join();
+    g_CaptureFreePixels.clear();
+    g_CaptureStarted = false;
+
+    if (g_CaptureOptions.directory != NULL)
+        printf("Captura: %u quadros gravados em \"%s\"", g_CaptureWritten, g_CaptureOptions.directory);
+    else
+        printf("Captura: nenhum quadro gravado");
+    printf(" (%u descartados)\n", g_CaptureDropped);
+    if (g_CaptureOptions.golden_directory != NULL)
+        printf("Comparação com \"%s\": %u iguais, %u diferentes, %u sem referência\n",
+               g_CaptureOptions.golden_directory, g_GoldenEqual, g_GoldenDifferent, g_GoldenMissing);
+}
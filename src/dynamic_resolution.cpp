@@ -0,0 +1,222 @@
+// Resolução dinâmica da cena 3D. Veja dynamic_resolution.h.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <glad/glad.h>
+
+#include "dynamic_resolution.h"
+#include "gl_debug.h"
+
+// Consultas em anel: a de um quadro só é lida QUERY_RING quadros depois, e
+// descartada se ainda não estiver pronta.
+static const int QUERY_RING = 4;
+
+// A escala só muda a cada ADJUST_INTERVAL quadros, em passos de
+// SCALE_STEP, para não realocar o framebuffer nem oscilar a cada quadro.
+static const int ADJUST_INTERVAL = 15;
+static const float SCALE_STEP = 0.05f;
+
+// Faixa de tempo, relativa ao orçamento, em que a escala não muda.
+static const double LOWER_MARGIN = 0.75;
+
+// Peso de cada medida na média móvel do tempo da cena.
+static const double SMOOTHING = 0.1;
+
+static bool g_Enabled = false;
+static double g_BudgetMs = 0.0;
+static float g_MinScale = 1.0f;
+static float g_Scale = 1.0f;
+static double g_SceneMs = 0.0;
+static bool g_HaveSample = false;
+static int g_FramesSinceAdjust = 0;
+
+static GLuint g_Queries[QUERY_RING];
+static bool g_QueryPending[QUERY_RING];
+static int g_NextQuery = 0;
+
+static GLuint g_Framebuffer = 0;
+// A cor é um renderbuffer, e não uma textura: só é lida por
+// glBlitFramebuffer(), e assim a alocação não mexe nas unidades de textura
+// (a 31 guarda a fonte do texto, veja textrendering.cpp).
+static GLuint g_ColorBuffer = 0;
+static GLuint g_DepthBuffer = 0;
+static int g_BufferWidth = 0;
+static int g_BufferHeight = 0;
+
+// Tamanho da cena e da janela no quadro atual, e o framebuffer da janela
+// (0, ou o framebuffer object do modo offscreen).
+static GLuint g_TargetFramebuffer = 0;
+static int g_SceneWidth = 0;
+static int g_SceneHeight = 0;
+static int g_WindowWidth = 0;
+static int g_WindowHeight = 0;
+
+void DynamicResolution_Init(double budget_ms, float min_scale)
+{
+    if (budget_ms <= 0.0)
+        return;
+
+    g_Enabled = true;
+    g_BudgetMs = budget_ms;
+    g_MinScale = min_scale < SCALE_STEP ? SCALE_STEP : (min_scale > 1.0f ? 1.0f : min_scale);
+    g_Scale = 1.0f;
+    glGenQueries(QUERY_RING, g_Queries);
+    for (int i = 0; i < QUERY_RING; ++i)
+        g_QueryPending[i] = false;
+    printf("Resolução dinâmica: orçamento de %.2f ms de GPU para a cena, escala mínima %.0f%%\n",
+           g_BudgetMs, g_MinScale * 100.0f);
+}
+
+bool DynamicResolution_Enabled()
+{
+    return g_Enabled;
+}
+
+// (Re)cria o framebuffer da cena com pelo menos "width" x "height" pixels.
+// Ele só cresce; uma escala menor usa uma parte dele.
+static void EnsureFramebuffer(int width, int height)
+{
+    if (g_Framebuffer != 0 && width <= g_BufferWidth && height <= g_BufferHeight)
+        return;
+
+    if (g_Framebuffer == 0)
+    {
+        glGenFramebuffers(1, &g_Framebuffer);
+        glGenRenderbuffers(1, &g_ColorBuffer);
+        glGenRenderbuffers(1, &g_DepthBuffer);
+    }
+    g_BufferWidth = width > g_BufferWidth ? width : g_BufferWidth;
+    g_BufferHeight = height > g_BufferHeight ? height : g_BufferHeight;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, g_ColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, g_BufferWidth, g_BufferHeight);
+    glBindRenderbuffer(GL_RENDERBUFFER, g_DepthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, g_BufferWidth, g_BufferHeight);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, g_Framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, g_ColorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, g_DepthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "ERRO: framebuffer da resolução dinâmica de %dx%d incompleto; desligando.\n",
+                g_BufferWidth, g_BufferHeight);
+        g_Enabled = false;
+        g_Scale = 1.0f;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, g_TargetFramebuffer);
+    GL_DEBUG_LABEL(GL_FRAMEBUFFER, g_Framebuffer, "resolução dinâmica");
+    GL_DEBUG_LABEL(GL_RENDERBUFFER, g_ColorBuffer, "resolução dinâmica: cor");
+}
+
+// Lê a consulta que vai ser reutilizada e ajusta a escala. O tempo da cena
+// cresce com o número de pixels, isto é, com o quadrado da escala.
+static void UpdateScale(GLuint query, bool pending)
+{
+    if (pending)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint64 elapsed_ns = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed_ns);
+            double ms = elapsed_ns / 1.0e6;
+            g_SceneMs = g_HaveSample ? g_SceneMs + SMOOTHING * (ms - g_SceneMs) : ms;
+            g_HaveSample = true;
+        }
+    }
+
+    if (!g_HaveSample || ++g_FramesSinceAdjust < ADJUST_INTERVAL)
+        return;
+    g_FramesSinceAdjust = 0;
+    if (g_SceneMs <= g_BudgetMs && g_SceneMs >= LOWER_MARGIN * g_BudgetMs)
+        return;
+
+    // Alvo no meio da faixa, com no máximo dois passos por ajuste.
+    double target = 0.5 * (1.0 + LOWER_MARGIN) * g_BudgetMs;
+    float wanted = g_Scale * (float)std::sqrt(target / std::max(g_SceneMs, 0.001));
+    wanted = std::floor(wanted / SCALE_STEP + 0.5f) * SCALE_STEP;
+    if (wanted > g_Scale + 2.0f * SCALE_STEP)
+        wanted = g_Scale + 2.0f * SCALE_STEP;
+    if (wanted < g_Scale - 2.0f * SCALE_STEP)
+        wanted = g_Scale - 2.0f * SCALE_STEP;
+    g_Scale = wanted < g_MinScale ? g_MinScale : (wanted > 1.0f ? 1.0f : wanted);
+}
+
+void DynamicResolution_BeginScene(int width, int height)
+{
+    g_WindowWidth = width;
+    g_WindowHeight = height;
+    g_SceneWidth = width;
+    g_SceneHeight = height;
+    if (!g_Enabled)
+        return;
+
+    int slot = g_NextQuery;
+    UpdateScale(g_Queries[slot], g_QueryPending[slot]);
+
+    if (g_Scale < 1.0f)
+    {
+        int scene_width = std::max(1, (int)(width * g_Scale + 0.5f));
+        int scene_height = std::max(1, (int)(height * g_Scale + 0.5f));
+        GLint target = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+        g_TargetFramebuffer = (GLuint)target;
+        EnsureFramebuffer(scene_width, scene_height);
+        if (!g_Enabled)
+            return;
+        g_SceneWidth = scene_width;
+        g_SceneHeight = scene_height;
+        glBindFramebuffer(GL_FRAMEBUFFER, g_Framebuffer);
+        glViewport(0, 0, g_SceneWidth, g_SceneHeight);
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, g_Queries[slot]);
+    g_QueryPending[slot] = true;
+}
+
+void DynamicResolution_EndScene()
+{
+    if (!g_Enabled)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    g_NextQuery = (g_NextQuery + 1) % QUERY_RING;
+
+    if (g_SceneWidth == g_WindowWidth && g_SceneHeight == g_WindowHeight)
+        return;
+
+    // Amplia a parte usada do framebuffer para a janela inteira.
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, g_Framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, g_TargetFramebuffer);
+    glBlitFramebuffer(0, 0, g_SceneWidth, g_SceneHeight, 0, 0, g_WindowWidth, g_WindowHeight,
+                      GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, g_TargetFramebuffer);
+    glViewport(0, 0, g_WindowWidth, g_WindowHeight);
+}
+
+float DynamicResolution_Scale()
+{
+    return g_Scale;
+}
+
+double DynamicResolution_SceneMs()
+{
+    return g_SceneMs;
+}
+
+void DynamicResolution_Finish()
+{
+    if (g_Framebuffer != 0)
+    {
+        glDeleteFramebuffers(1, &g_Framebuffer);
+        glDeleteRenderbuffers(1, &g_ColorBuffer);
+        glDeleteRenderbuffers(1, &g_DepthBuffer);
+        g_Framebuffer = 0;
+    }
+    if (g_BudgetMs > 0.0)
+        glDeleteQueries(QUERY_RING, g_Queries);
+    g_BudgetMs = 0.0;
+    g_Enabled = false;
+}
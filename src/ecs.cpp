@@ -0,0 +1,168 @@
+// Armazenamento de entidades por arquétipo. Veja ecs.h.
+#include <cstdio>
+#include <cstdlib>
+
+#include "ecs.h"
+
+static const int ENTITY_INDEX_BITS = 20;
+static const int ENTITY_INDEX_MASK = ENTITY_MAX_COUNT - 1;
+static const int ENTITY_GENERATION_MASK = (1 << (31 - ENTITY_INDEX_BITS)) - 1;
+
+static EntityId MakeEntityId(int index, int generation)
+{
+    return (generation << ENTITY_INDEX_BITS) | index;
+}
+
+// Aplica "op" ao vetor de cada componente presente no arquétipo. Usado para
+// adicionar e remover linhas sem repetir a lista de componentes.
+template <typename Op>
+static void ForEachColumn(Archetype& a, Op op)
+{
+    if (a.mask & COMPONENT_TRANSFORM)    op(a.transforms);
+    if (a.mask & COMPONENT_MOTION)       op(a.motions);
+    if (a.mask & COMPONENT_HEALTH)       op(a.healths);
+    if (a.mask & COMPONENT_LIFETIME)     op(a.lifetimes);
+    if (a.mask & COMPONENT_RENDERABLE)   op(a.renderables);
+    if (a.mask & COMPONENT_COLLIDER)     op(a.colliders);
+    if (a.mask & COMPONENT_STATIC_MODEL) op(a.static_models);
+}
+
+struct PushDefault
+{
+    template <typename T> void operator()(std::vector<T>& column) const { column.push_back(T()); }
+};
+
+// Move a linha "last" para "row" e descarta a última linha.
+struct SwapRemove
+{
+    size_t row;
+    template <typename T> void operator()(std::vector<T>& column) const
+    {
+        column[row] = column.back();
+        column.pop_back();
+    }
+};
+
+int World::FindOrAddArchetype(ComponentMask mask)
+{
+    for (size_t i = 0; i < archetypes_.size(); ++i)
+        if (archetypes_[i].mask == mask)
+            return static_cast<int>(i);
+
+    archetypes_.push_back(Archetype());
+    archetypes_.back().mask = mask;
+    return static_cast<int>(archetypes_.size() - 1);
+}
+
+EntityId World::Create(ComponentMask mask)
+{
+    int index;
+    if (!free_indices_.empty())
+    {
+        index = free_indices_.back();
+        free_indices_.pop_back();
+    }
+    else
+    {
+        // Um índice maior invadiria os bits da geração, e identificadores
+        // de entidades diferentes seriam iguais.
+        if (records_.size() > static_cast<size_t>(ENTITY_INDEX_MASK))
+        {
+            fprintf(stderr, "ERRO: mais de %d entidades (veja ENTITY_MAX_COUNT em ecs.h).\n", ENTITY_MAX_COUNT);
+            std::abort();
+        }
+        index = static_cast<int>(records_.size());
+        EntityRecord record = { -1, 0, 0 };
+        records_.push_back(record);
+    }
+
+    int archetype_index = FindOrAddArchetype(mask);
+    Archetype& archetype = archetypes_[archetype_index];
+    EntityId id = MakeEntityId(index, records_[index].generation);
+
+    records_[index].archetype = archetype_index;
+    records_[index].row = static_cast<int>(archetype.Size());
+    archetype.entities.push_back(id);
+    ForEachColumn(archetype, PushDefault());
+    return id;
+}
+
+bool World::Locate(EntityId id, Archetype** archetype, size_t* row)
+{
+    if (!IsAlive(id))
+        return false;
+    const EntityRecord& record = records_[id & ENTITY_INDEX_MASK];
+    *archetype = &archetypes_[record.archetype];
+    *row = static_cast<size_t>(record.row);
+    return true;
+}
+
+bool World::IsAlive(EntityId id) const
+{
+    if (id < 0)
+        return false;
+    size_t index = static_cast<size_t>(id & ENTITY_INDEX_MASK);
+    if (index >= records_.size())
+        return false;
+    const EntityRecord& record = records_[index];
+    return record.archetype >= 0 && record.generation == (id >> ENTITY_INDEX_BITS);
+}
+
+void World::Destroy(EntityId id)
+{
+    Archetype* archetype;
+    size_t row;
+    if (!Locate(id, &archetype, &row))
+        return;
+
+    // A entidade da última linha passa a ocupar a linha removida.
+    EntityId moved = archetype->entities.back();
+    archetype->entities[row] = moved;
+    archetype->entities.pop_back();
+    SwapRemove swap = { row };
+    ForEachColumn(*archetype, swap);
+    records_[moved & ENTITY_INDEX_MASK].row = static_cast<int>(row);
+
+    int index = id & ENTITY_INDEX_MASK;
+    records_[index].archetype = -1;
+    records_[index].generation = (records_[index].generation + 1) & ENTITY_GENERATION_MASK;
+    free_indices_.push_back(index);
+}
+
+size_t World::Count(ComponentMask required) const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < archetypes_.size(); ++i)
+        if (archetypes_[i].Matches(required))
+            count += archetypes_[i].Size();
+    return count;
+}
+
+void World::Clear()
+{
+    for (size_t i = 0; i < archetypes_.size(); ++i)
+        for (size_t j = archetypes_[i].Size(); j > 0; --j)
+            Destroy(archetypes_[i].entities[j - 1]);
+}
+
+// Os acessores abaixo diferem só no componente e no vetor.
+#define ECS_COMPONENT_GETTER(Type, Bit, column)             \
+    Type* World::Get##Type(EntityId id)                    \
+    {                                                      \
+        Archetype* archetype;                              \
+        size_t row;                                        \
+        if (!Locate(id, &archetype, &row) ||               \
+            !(archetype->mask & Bit))                      \
+            return NULL;                                   \
+        return &archetype->column[row];                    \
+    }
+
+ECS_COMPONENT_GETTER(Transform, COMPONENT_TRANSFORM, transforms)
+ECS_COMPONENT_GETTER(Motion, COMPONENT_MOTION, motions)
+ECS_COMPONENT_GETTER(Health, COMPONENT_HEALTH, healths)
+ECS_COMPONENT_GETTER(Lifetime, COMPONENT_LIFETIME, lifetimes)
+ECS_COMPONENT_GETTER(Renderable, COMPONENT_RENDERABLE, renderables)
+ECS_COMPONENT_GETTER(Collider, COMPONENT_COLLIDER, colliders)
+ECS_COMPONENT_GETTER(StaticModel, COMPONENT_STATIC_MODEL, static_models)
+
+#undef ECS_COMPONENT_GETTER
@@ -0,0 +1,81 @@
+// Limite de quadros em voo. Veja frame_fences.h.
+#include <cstdio>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "frame_fences.h"
+#include "pacing.h"
+#include "stats.h"
+
+// Intervalo de cada chamada a glClientWaitSync(), em nanossegundos; a
+// espera é repetida até a fence ser sinalizada.
+static const GLuint64 FENCE_WAIT_TIMEOUT = 100000000;
+
+static int g_MaxFrames = 0;
+static GLsync g_Fences[FRAME_FENCES_MAX];
+static int g_NextFence = 0;
+static double g_LastWaitMs = 0.0;
+static std::vector<double> g_WaitTimes;
+
+void FrameFences_Init(int max_frames)
+{
+    g_MaxFrames = max_frames < 0 ? 0 : (max_frames > FRAME_FENCES_MAX ? FRAME_FENCES_MAX : max_frames);
+    for (int i = 0; i < FRAME_FENCES_MAX; ++i)
+        g_Fences[i] = NULL;
+    g_NextFence = 0;
+    if (g_MaxFrames > 0)
+        printf("Quadros em voo: no máximo %d\n", g_MaxFrames);
+}
+
+void FrameFences_EndFrame()
+{
+    if (g_MaxFrames == 0)
+        return;
+
+    g_Fences[g_NextFence] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    g_NextFence = (g_NextFence + 1) % g_MaxFrames;
+
+    // Com o anel de g_MaxFrames posições, a próxima é a fence mais antiga
+    // (com limite 1, a que acabou de ser criada).
+    GLsync oldest = g_Fences[g_NextFence];
+    if (oldest == NULL)
+        return;
+
+    double start = Pacing_Now();
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    for (;;)
+    {
+        GLenum result = glClientWaitSync(oldest, flags, FENCE_WAIT_TIMEOUT);
+        if (result != GL_TIMEOUT_EXPIRED)
+            break;
+        flags = 0;
+    }
+    glDeleteSync(oldest);
+    g_Fences[g_NextFence] = NULL;
+
+    g_LastWaitMs = (Pacing_Now() - start) * 1000.0;
+    g_WaitTimes.push_back(g_LastWaitMs);
+}
+
+double FrameFences_LastWaitMs()
+{
+    return g_LastWaitMs;
+}
+
+void FrameFences_Finish()
+{
+    for (int i = 0; i < FRAME_FENCES_MAX; ++i)
+    {
+        if (g_Fences[i] != NULL)
+            glDeleteSync(g_Fences[i]);
+        g_Fences[i] = NULL;
+    }
+    if (g_WaitTimes.empty())
+        return;
+
+    char label[64];
+    snprintf(label, sizeof(label), "Espera pela GPU (%d quadros em voo)", g_MaxFrames);
+    Stats_PrintFrames(label, g_WaitTimes);
+    g_WaitTimes.clear();
+}
@@ -0,0 +1,170 @@
+// Camada de depuração OpenGL. Veja gl_debug.h.
+#include <cstdio>
+#include <cstring>
+
+#include "gl_debug.h"
+
+#ifdef GL_DEBUG_ENABLED
+
+// Constantes e funções de GL_KHR_debug e GL_ARB_debug_output, que a GLAD
+// (gerada para o OpenGL 3.3 sem extensões) não carrega.
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS       0x8242
+#define GL_DEBUG_SOURCE_API               0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM     0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER   0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY       0x8249
+#define GL_DEBUG_SOURCE_APPLICATION       0x824A
+#define GL_DEBUG_TYPE_ERROR               0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR  0x824E
+#define GL_DEBUG_TYPE_PORTABILITY         0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE         0x8250
+#define GL_DEBUG_TYPE_PUSH_GROUP          0x8269
+#define GL_DEBUG_TYPE_POP_GROUP           0x826A
+#define GL_DEBUG_SEVERITY_HIGH            0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM          0x9147
+#define GL_DEBUG_SEVERITY_LOW             0x9148
+#define GL_DEBUG_SEVERITY_NOTIFICATION    0x826B
+#define GL_DEBUG_OUTPUT                   0x92E0
+
+typedef void (APIENTRY *PFN_glDebugMessageCallback)(GLDEBUGPROC callback, const void* user_param);
+typedef void (APIENTRY *PFN_glDebugMessageControl)(GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint* ids, GLboolean enabled);
+typedef void (APIENTRY *PFN_glObjectLabel)(GLenum identifier, GLuint name, GLsizei length, const GLchar* label);
+typedef void (APIENTRY *PFN_glPushDebugGroup)(GLenum source, GLuint id, GLsizei length, const GLchar* message);
+typedef void (APIENTRY *PFN_glPopDebugGroup)();
+
+// Só GL_KHR_debug tem nomes de objetos e grupos; com GL_ARB_debug_output
+// esses ponteiros ficam NULL.
+static PFN_glObjectLabel g_glObjectLabel = NULL;
+static PFN_glPushDebugGroup g_glPushDebugGroup = NULL;
+static PFN_glPopDebugGroup g_glPopDebugGroup = NULL;
+
+static bool HasExtension(const char* extension)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        if (name != NULL && strcmp(name, extension) == 0)
+            return true;
+    }
+    return false;
+}
+
+static const char* SourceName(GLenum source)
+{
+    switch (source)
+    {
+        case GL_DEBUG_SOURCE_API:             return "API";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "janela";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "compilador de shaders";
+        case GL_DEBUG_SOURCE_THIRD_PARTY:     return "terceiros";
+        case GL_DEBUG_SOURCE_APPLICATION:     return "aplicação";
+        default:                              return "outra";
+    }
+}
+
+static const char* TypeName(GLenum type)
+{
+    switch (type)
+    {
+        case GL_DEBUG_TYPE_ERROR:               return "erro";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "obsoleto";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "comportamento indefinido";
+        case GL_DEBUG_TYPE_PORTABILITY:         return "portabilidade";
+        case GL_DEBUG_TYPE_PERFORMANCE:         return "desempenho";
+        default:                                return "outro";
+    }
+}
+
+static void APIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+                                          GLsizei, const GLchar* message, const void*)
+{
+    if (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP)
+        return;
+
+    const char* prefix = severity == GL_DEBUG_SEVERITY_HIGH || type == GL_DEBUG_TYPE_ERROR ? "ERRO" : "AVISO";
+    fprintf(stderr, "%s: OpenGL (%s, %s, id %u): %s\n", prefix, SourceName(source), TypeName(type), id, message);
+}
+
+bool GlDebug_Init(GLADloadproc load)
+{
+    PFN_glDebugMessageCallback callback = NULL;
+    PFN_glDebugMessageControl control = NULL;
+    const char* extension = NULL;
+    if (HasExtension("GL_KHR_debug"))
+    {
+        extension = "GL_KHR_debug";
+        callback = (PFN_glDebugMessageCallback)load("glDebugMessageCallback");
+        control = (PFN_glDebugMessageControl)load("glDebugMessageControl");
+        g_glObjectLabel = (PFN_glObjectLabel)load("glObjectLabel");
+        g_glPushDebugGroup = (PFN_glPushDebugGroup)load("glPushDebugGroup");
+        g_glPopDebugGroup = (PFN_glPopDebugGroup)load("glPopDebugGroup");
+    }
+    else if (HasExtension("GL_ARB_debug_output"))
+    {
+        extension = "GL_ARB_debug_output";
+        callback = (PFN_glDebugMessageCallback)load("glDebugMessageCallbackARB");
+        control = (PFN_glDebugMessageControl)load("glDebugMessageControlARB");
+    }
+    if (callback == NULL || control == NULL)
+    {
+        fprintf(stderr, "AVISO: nem GL_KHR_debug nem GL_ARB_debug_output disponíveis; sem mensagens de depuração OpenGL.\n");
+        g_glObjectLabel = NULL;
+        g_glPushDebugGroup = NULL;
+        g_glPopDebugGroup = NULL;
+        return false;
+    }
+
+    // As mensagens são síncronas: a função é chamada dentro da chamada
+    // OpenGL com erro, que aparece na pilha do depurador. As notificações
+    // (ex: informações de alocação de buffers) são ignoradas.
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    control(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, NULL, GL_TRUE);
+    control(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, NULL, GL_FALSE);
+    callback(DebugMessageCallback, NULL);
+
+    printf("Depuração OpenGL: %s\n", extension);
+    return true;
+}
+
+void GlDebug_Label(GLenum identifier, GLuint name, const char* label)
+{
+    if (g_glObjectLabel != NULL)
+        g_glObjectLabel(identifier, name, -1, label);
+}
+
+void GlDebug_PushGroup(const char* name)
+{
+    if (g_glPushDebugGroup != NULL)
+        g_glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+void GlDebug_PopGroup()
+{
+    if (g_glPopDebugGroup != NULL)
+        g_glPopDebugGroup();
+}
+
+#else
+
+bool GlDebug_Init(GLADloadproc)
+{
+    return false;
+}
+
+void GlDebug_Label(GLenum, GLuint, const char*)
+{
+}
+
+void GlDebug_PushGroup(const char*)
+{
+}
+
+void GlDebug_PopGroup()
+{
+}
+
+#endif // GL_DEBUG_ENABLED
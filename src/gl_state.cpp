@@ -0,0 +1,297 @@
+// Cache do estado OpenGL. Veja gl_state.h.
+#include <glad/glad.h>
+
+#include "gl_state.h"
+
+// Valor guardado quando o estado atual não é conhecido. Nenhum nome de
+// objeto nem enum OpenGL tem esse valor.
+static const GLuint UNKNOWN = 0xFFFFFFFFu;
+
+// Unidades de textura em cache; glBindTexture e glBindSampler nas unidades
+// acima destas sempre chegam ao driver.
+static const unsigned int CACHED_TEXTURE_UNITS = 32;
+
+// Estados habilitados por glEnable/glDisable que ficam em cache.
+enum GlCapability
+{
+    CAP_BLEND,
+    CAP_DEPTH_TEST,
+    CAP_CULL_FACE,
+    CAP_COUNT
+};
+
+struct GlStateCache
+{
+    GLuint program;
+    GLuint vertex_array;
+    GLuint array_buffer;
+    GLuint pixel_pack_buffer;
+    GLuint active_unit;
+    GLuint textures[CACHED_TEXTURE_UNITS]; // GL_TEXTURE_2D de cada unidade
+    GLuint samplers[CACHED_TEXTURE_UNITS];
+    GLuint capabilities[CAP_COUNT];        // GL_TRUE, GL_FALSE ou UNKNOWN
+    GLuint blend_source;
+    GLuint blend_destination;
+    GLuint depth_func;
+    GLuint depth_mask;
+    GLuint polygon_mode;
+};
+
+static bool g_GlStateInstalled = false;
+static GlStateCache g_GlState;
+static unsigned int g_GlStateSkipped = 0;
+
+// Funções originais da GLAD (ou dos contadores de gl_stats.h).
+static PFNGLUSEPROGRAMPROC g_RealUseProgram;
+static PFNGLBINDVERTEXARRAYPROC g_RealBindVertexArray;
+static PFNGLBINDBUFFERPROC g_RealBindBuffer;
+static PFNGLACTIVETEXTUREPROC g_RealActiveTexture;
+static PFNGLBINDTEXTUREPROC g_RealBindTexture;
+static PFNGLBINDSAMPLERPROC g_RealBindSampler;
+static PFNGLENABLEPROC g_RealEnable;
+static PFNGLDISABLEPROC g_RealDisable;
+static PFNGLBLENDFUNCPROC g_RealBlendFunc;
+static PFNGLDEPTHFUNCPROC g_RealDepthFunc;
+static PFNGLDEPTHMASKPROC g_RealDepthMask;
+static PFNGLPOLYGONMODEPROC g_RealPolygonMode;
+static PFNGLDELETEPROGRAMPROC g_RealDeleteProgram;
+static PFNGLDELETEVERTEXARRAYSPROC g_RealDeleteVertexArrays;
+static PFNGLDELETEBUFFERSPROC g_RealDeleteBuffers;
+static PFNGLDELETETEXTURESPROC g_RealDeleteTextures;
+static PFNGLDELETESAMPLERSPROC g_RealDeleteSamplers;
+
+// Guarda "value" em "cached" e retorna true se a chamada precisa chegar ao
+// driver.
+static bool Changes(GLuint& cached, GLuint value)
+{
+    if (cached == value)
+    {
+        ++g_GlStateSkipped;
+        return false;
+    }
+    cached = value;
+    return true;
+}
+
+static GLuint* CachedBuffer(GLenum target)
+{
+    // GL_ELEMENT_ARRAY_BUFFER faz parte do VAO e não fica em cache.
+    if (target == GL_ARRAY_BUFFER)
+        return &g_GlState.array_buffer;
+    if (target == GL_PIXEL_PACK_BUFFER)
+        return &g_GlState.pixel_pack_buffer;
+    return NULL;
+}
+
+static GLuint* CachedCapability(GLenum capability)
+{
+    if (capability == GL_BLEND)
+        return &g_GlState.capabilities[CAP_BLEND];
+    if (capability == GL_DEPTH_TEST)
+        return &g_GlState.capabilities[CAP_DEPTH_TEST];
+    if (capability == GL_CULL_FACE)
+        return &g_GlState.capabilities[CAP_CULL_FACE];
+    return NULL;
+}
+
+static void APIENTRY CacheUseProgram(GLuint program)
+{
+    if (Changes(g_GlState.program, program))
+        g_RealUseProgram(program);
+}
+
+static void APIENTRY CacheBindVertexArray(GLuint array)
+{
+    if (Changes(g_GlState.vertex_array, array))
+        g_RealBindVertexArray(array);
+}
+
+static void APIENTRY CacheBindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint* cached = CachedBuffer(target);
+    if (cached == NULL || Changes(*cached, buffer))
+        g_RealBindBuffer(target, buffer);
+}
+
+static void APIENTRY CacheActiveTexture(GLenum texture)
+{
+    if (Changes(g_GlState.active_unit, texture - GL_TEXTURE0))
+        g_RealActiveTexture(texture);
+}
+
+static void APIENTRY CacheBindTexture(GLenum target, GLuint texture)
+{
+    GLuint unit = g_GlState.active_unit;
+    if (target != GL_TEXTURE_2D || unit >= CACHED_TEXTURE_UNITS || Changes(g_GlState.textures[unit], texture))
+        g_RealBindTexture(target, texture);
+}
+
+static void APIENTRY CacheBindSampler(GLuint unit, GLuint sampler)
+{
+    if (unit >= CACHED_TEXTURE_UNITS || Changes(g_GlState.samplers[unit], sampler))
+        g_RealBindSampler(unit, sampler);
+}
+
+static void APIENTRY CacheEnable(GLenum capability)
+{
+    GLuint* cached = CachedCapability(capability);
+    if (cached == NULL || Changes(*cached, GL_TRUE))
+        g_RealEnable(capability);
+}
+
+static void APIENTRY CacheDisable(GLenum capability)
+{
+    GLuint* cached = CachedCapability(capability);
+    if (cached == NULL || Changes(*cached, GL_FALSE))
+        g_RealDisable(capability);
+}
+
+static void APIENTRY CacheBlendFunc(GLenum source, GLenum destination)
+{
+    if (g_GlState.blend_source == source && g_GlState.blend_destination == destination)
+    {
+        ++g_GlStateSkipped;
+        return;
+    }
+    g_GlState.blend_source = source;
+    g_GlState.blend_destination = destination;
+    g_RealBlendFunc(source, destination);
+}
+
+static void APIENTRY CacheDepthFunc(GLenum func)
+{
+    if (Changes(g_GlState.depth_func, func))
+        g_RealDepthFunc(func);
+}
+
+static void APIENTRY CacheDepthMask(GLboolean flag)
+{
+    if (Changes(g_GlState.depth_mask, flag))
+        g_RealDepthMask(flag);
+}
+
+static void APIENTRY CachePolygonMode(GLenum face, GLenum mode)
+{
+    // No perfil core só GL_FRONT_AND_BACK é válido; qualquer outra face
+    // deixa o estado desconhecido.
+    if (face != GL_FRONT_AND_BACK)
+        g_GlState.polygon_mode = UNKNOWN;
+    else if (!Changes(g_GlState.polygon_mode, mode))
+        return;
+    g_RealPolygonMode(face, mode);
+}
+
+// Um programa apagado continua em uso até ser desligado, mas o seu nome pode
+// voltar a ser usado depois disso; na dúvida o estado fica desconhecido.
+static void APIENTRY CacheDeleteProgram(GLuint program)
+{
+    if (g_GlState.program == program)
+        g_GlState.program = UNKNOWN;
+    g_RealDeleteProgram(program);
+}
+
+// Apagar um objeto ligado o desliga, voltando ao objeto 0.
+static void APIENTRY CacheDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    for (GLsizei i = 0; i < n; ++i)
+        if (arrays[i] != 0 && g_GlState.vertex_array == arrays[i])
+            g_GlState.vertex_array = 0;
+    g_RealDeleteVertexArrays(n, arrays);
+}
+
+static void APIENTRY CacheDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    for (GLsizei i = 0; i < n; ++i)
+    {
+        if (buffers[i] == 0)
+            continue;
+        if (g_GlState.array_buffer == buffers[i])
+            g_GlState.array_buffer = 0;
+        if (g_GlState.pixel_pack_buffer == buffers[i])
+            g_GlState.pixel_pack_buffer = 0;
+    }
+    g_RealDeleteBuffers(n, buffers);
+}
+
+static void APIENTRY CacheDeleteTextures(GLsizei n, const GLuint* textures)
+{
+    for (GLsizei i = 0; i < n; ++i)
+        for (unsigned int unit = 0; unit < CACHED_TEXTURE_UNITS; ++unit)
+            if (textures[i] != 0 && g_GlState.textures[unit] == textures[i])
+                g_GlState.textures[unit] = 0;
+    g_RealDeleteTextures(n, textures);
+}
+
+static void APIENTRY CacheDeleteSamplers(GLsizei n, const GLuint* samplers)
+{
+    for (GLsizei i = 0; i < n; ++i)
+        for (unsigned int unit = 0; unit < CACHED_TEXTURE_UNITS; ++unit)
+            if (samplers[i] != 0 && g_GlState.samplers[unit] == samplers[i])
+                g_GlState.samplers[unit] = 0;
+    g_RealDeleteSamplers(n, samplers);
+}
+
+#define GL_STATE_WRAP(name) g_Real##name = glad_gl##name; glad_gl##name = Cache##name
+
+void GlState_Install()
+{
+    if (g_GlStateInstalled)
+        return;
+
+    GL_STATE_WRAP(UseProgram);
+    GL_STATE_WRAP(BindVertexArray);
+    GL_STATE_WRAP(BindBuffer);
+    GL_STATE_WRAP(ActiveTexture);
+    GL_STATE_WRAP(BindTexture);
+    GL_STATE_WRAP(BindSampler);
+    GL_STATE_WRAP(Enable);
+    GL_STATE_WRAP(Disable);
+    GL_STATE_WRAP(BlendFunc);
+    GL_STATE_WRAP(DepthFunc);
+    GL_STATE_WRAP(DepthMask);
+    GL_STATE_WRAP(PolygonMode);
+    GL_STATE_WRAP(DeleteProgram);
+    GL_STATE_WRAP(DeleteVertexArrays);
+    GL_STATE_WRAP(DeleteBuffers);
+    GL_STATE_WRAP(DeleteTextures);
+    GL_STATE_WRAP(DeleteSamplers);
+
+    GlState_Invalidate();
+    g_GlStateSkipped = 0;
+    g_GlStateInstalled = true;
+}
+
+#undef GL_STATE_WRAP
+
+bool GlState_Installed()
+{
+    return g_GlStateInstalled;
+}
+
+void GlState_Invalidate()
+{
+    g_GlState.program = UNKNOWN;
+    g_GlState.vertex_array = UNKNOWN;
+    g_GlState.array_buffer = UNKNOWN;
+    g_GlState.pixel_pack_buffer = UNKNOWN;
+    g_GlState.active_unit = UNKNOWN;
+    for (unsigned int unit = 0; unit < CACHED_TEXTURE_UNITS; ++unit)
+    {
+        g_GlState.textures[unit] = UNKNOWN;
+        g_GlState.samplers[unit] = UNKNOWN;
+    }
+    for (int cap = 0; cap < CAP_COUNT; ++cap)
+        g_GlState.capabilities[cap] = UNKNOWN;
+    g_GlState.blend_source = UNKNOWN;
+    g_GlState.blend_destination = UNKNOWN;
+    g_GlState.depth_func = UNKNOWN;
+    g_GlState.depth_mask = UNKNOWN;
+    g_GlState.polygon_mode = UNKNOWN;
+}
+
+unsigned int GlState_TakeSkipped()
+{
+    unsigned int skipped = g_GlStateSkipped;
+    g_GlStateSkipped = 0;
+    return skipped;
+}
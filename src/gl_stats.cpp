@@ -0,0 +1,218 @@
+// Contadores das chamadas OpenGL. Veja gl_stats.h.
+#include <cstdio>
+
+#include <glad/glad.h>
+
+#include "gl_stats.h"
+#include "gl_state.h"
+
+static bool g_GlStatsInstalled = false;
+static GlFrameStats g_GlCurrent;
+static GlFrameStats g_GlLast;
+static GlFrameStats g_GlTotal;
+static unsigned int g_GlFrames = 0;
+static FILE* g_GlStatsCsv = NULL;
+
+// Triângulos gerados por uma chamada de desenho com "count" vértices.
+static uint64_t Triangles(GLenum mode, GLsizei count, GLsizei instances)
+{
+    uint64_t per_instance = 0;
+    if (mode == GL_TRIANGLES)
+        per_instance = count / 3;
+    else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+        per_instance = count - 2;
+    return per_instance * instances;
+}
+
+// Funções originais da GLAD, chamadas pelas versões que contam.
+static PFNGLDRAWARRAYSPROC g_RealDrawArrays;
+static PFNGLDRAWARRAYSINSTANCEDPROC g_RealDrawArraysInstanced;
+static PFNGLDRAWELEMENTSPROC g_RealDrawElements;
+static PFNGLDRAWELEMENTSINSTANCEDPROC g_RealDrawElementsInstanced;
+static PFNGLUSEPROGRAMPROC g_RealUseProgram;
+static PFNGLBINDVERTEXARRAYPROC g_RealBindVertexArray;
+static PFNGLBINDTEXTUREPROC g_RealBindTexture;
+static PFNGLBUFFERDATAPROC g_RealBufferData;
+static PFNGLBUFFERSUBDATAPROC g_RealBufferSubData;
+
+static void APIENTRY CountDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    ++g_GlCurrent.draw_calls;
+    g_GlCurrent.triangles += Triangles(mode, count, 1);
+    g_RealDrawArrays(mode, first, count);
+}
+
+static void APIENTRY CountDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+{
+    ++g_GlCurrent.draw_calls;
+    g_GlCurrent.triangles += Triangles(mode, count, instances);
+    g_RealDrawArraysInstanced(mode, first, count, instances);
+}
+
+static void APIENTRY CountDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    ++g_GlCurrent.draw_calls;
+    g_GlCurrent.triangles += Triangles(mode, count, 1);
+    g_RealDrawElements(mode, count, type, indices);
+}
+
+static void APIENTRY CountDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances)
+{
+    ++g_GlCurrent.draw_calls;
+    g_GlCurrent.triangles += Triangles(mode, count, instances);
+    g_RealDrawElementsInstanced(mode, count, type, indices, instances);
+}
+
+static void APIENTRY CountUseProgram(GLuint program)
+{
+    ++g_GlCurrent.program_binds;
+    g_RealUseProgram(program);
+}
+
+static void APIENTRY CountBindVertexArray(GLuint array)
+{
+    ++g_GlCurrent.vao_binds;
+    g_RealBindVertexArray(array);
+}
+
+static void APIENTRY CountBindTexture(GLenum target, GLuint texture)
+{
+    ++g_GlCurrent.texture_binds;
+    g_RealBindTexture(target, texture);
+}
+
+static void APIENTRY CountBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    ++g_GlCurrent.buffer_uploads;
+    g_GlCurrent.buffer_upload_bytes += size;
+    g_RealBufferData(target, size, data, usage);
+}
+
+static void APIENTRY CountBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    ++g_GlCurrent.buffer_uploads;
+    g_GlCurrent.buffer_upload_bytes += size;
+    g_RealBufferSubData(target, offset, size, data);
+}
+
+// Todas as variantes de glUniform usadas pelo programa só são contadas.
+#define GL_STATS_UNIFORM(name, proc, parameters, arguments) \
+    static proc g_Real##name;                                \
+    static void APIENTRY Count##name parameters              \
+    {                                                        \
+        ++g_GlCurrent.uniform_updates;                       \
+        g_Real##name arguments;                              \
+    }
+
+GL_STATS_UNIFORM(Uniform1i, PFNGLUNIFORM1IPROC, (GLint l, GLint v0), (l, v0))
+GL_STATS_UNIFORM(Uniform1f, PFNGLUNIFORM1FPROC, (GLint l, GLfloat v0), (l, v0))
+GL_STATS_UNIFORM(Uniform3f, PFNGLUNIFORM3FPROC, (GLint l, GLfloat v0, GLfloat v1, GLfloat v2), (l, v0, v1, v2))
+GL_STATS_UNIFORM(Uniform4f, PFNGLUNIFORM4FPROC, (GLint l, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3), (l, v0, v1, v2, v3))
+GL_STATS_UNIFORM(Uniform1fv, PFNGLUNIFORM1FVPROC, (GLint l, GLsizei n, const GLfloat* v), (l, n, v))
+GL_STATS_UNIFORM(Uniform3fv, PFNGLUNIFORM3FVPROC, (GLint l, GLsizei n, const GLfloat* v), (l, n, v))
+GL_STATS_UNIFORM(Uniform4fv, PFNGLUNIFORM4FVPROC, (GLint l, GLsizei n, const GLfloat* v), (l, n, v))
+GL_STATS_UNIFORM(UniformMatrix4fv, PFNGLUNIFORMMATRIX4FVPROC, (GLint l, GLsizei n, GLboolean t, const GLfloat* v), (l, n, t, v))
+
+#undef GL_STATS_UNIFORM
+
+#define GL_STATS_WRAP(name) g_Real##name = glad_gl##name; glad_gl##name = Count##name
+
+bool GlStats_Install(const char* csv_path)
+{
+    if (g_GlStatsInstalled)
+        return true;
+
+    if (csv_path != NULL)
+    {
+        g_GlStatsCsv = fopen(csv_path, "w");
+        if (g_GlStatsCsv == NULL)
+        {
+            fprintf(stderr, "ERRO: não foi possível criar \"%s\".\n", csv_path);
+            return false;
+        }
+        fprintf(g_GlStatsCsv, "quadro,desenhos,triangulos,programas,vaos,texturas,envios,bytes_enviados,uniforms,evitadas\n");
+    }
+
+    GL_STATS_WRAP(DrawArrays);
+    GL_STATS_WRAP(DrawArraysInstanced);
+    GL_STATS_WRAP(DrawElements);
+    GL_STATS_WRAP(DrawElementsInstanced);
+    GL_STATS_WRAP(UseProgram);
+    GL_STATS_WRAP(BindVertexArray);
+    GL_STATS_WRAP(BindTexture);
+    GL_STATS_WRAP(BufferData);
+    GL_STATS_WRAP(BufferSubData);
+    GL_STATS_WRAP(Uniform1i);
+    GL_STATS_WRAP(Uniform1f);
+    GL_STATS_WRAP(Uniform3f);
+    GL_STATS_WRAP(Uniform4f);
+    GL_STATS_WRAP(Uniform1fv);
+    GL_STATS_WRAP(Uniform3fv);
+    GL_STATS_WRAP(Uniform4fv);
+    GL_STATS_WRAP(UniformMatrix4fv);
+
+    g_GlCurrent = GlFrameStats();
+    g_GlLast = GlFrameStats();
+    g_GlTotal = GlFrameStats();
+    g_GlFrames = 0;
+    g_GlStatsInstalled = true;
+    return true;
+}
+
+#undef GL_STATS_WRAP
+
+bool GlStats_Installed()
+{
+    return g_GlStatsInstalled;
+}
+
+void GlStats_EndFrame()
+{
+    if (!g_GlStatsInstalled)
+        return;
+
+    g_GlLast = g_GlCurrent;
+    g_GlLast.state_skipped = GlState_TakeSkipped();
+    g_GlCurrent = GlFrameStats();
+
+    g_GlTotal.draw_calls += g_GlLast.draw_calls;
+    g_GlTotal.triangles += g_GlLast.triangles;
+    g_GlTotal.program_binds += g_GlLast.program_binds;
+    g_GlTotal.vao_binds += g_GlLast.vao_binds;
+    g_GlTotal.texture_binds += g_GlLast.texture_binds;
+    g_GlTotal.buffer_uploads += g_GlLast.buffer_uploads;
+    g_GlTotal.buffer_upload_bytes += g_GlLast.buffer_upload_bytes;
+    g_GlTotal.uniform_updates += g_GlLast.uniform_updates;
+    g_GlTotal.state_skipped += g_GlLast.state_skipped;
+
+    if (g_GlStatsCsv != NULL)
+        fprintf(g_GlStatsCsv, "%u,%u,%llu,%u,%u,%u,%u,%llu,%u,%u\n", g_GlFrames, g_GlLast.draw_calls,
+                (unsigned long long)g_GlLast.triangles, g_GlLast.program_binds, g_GlLast.vao_binds,
+                g_GlLast.texture_binds, g_GlLast.buffer_uploads, (unsigned long long)g_GlLast.buffer_upload_bytes,
+                g_GlLast.uniform_updates, g_GlLast.state_skipped);
+    ++g_GlFrames;
+}
+
+const GlFrameStats& GlStats_LastFrame()
+{
+    return g_GlLast;
+}
+
+void GlStats_Finish()
+{
+    if (g_GlStatsCsv != NULL)
+    {
+        fclose(g_GlStatsCsv);
+        g_GlStatsCsv = NULL;
+    }
+    if (!g_GlStatsInstalled || g_GlFrames == 0)
+        return;
+
+    double n = g_GlFrames;
+    printf("Chamadas OpenGL por quadro (média de %u quadros): %.1f desenhos, %.0f triângulos, %.1f programas, "
+           "%.1f VAOs, %.1f texturas, %.1f envios (%.0f bytes), %.1f uniforms, "
+           "%.1f chamadas evitadas pelo cache de estado\n",
+           g_GlFrames, g_GlTotal.draw_calls / n, g_GlTotal.triangles / n, g_GlTotal.program_binds / n,
+           g_GlTotal.vao_binds / n, g_GlTotal.texture_binds / n, g_GlTotal.buffer_uploads / n,
+           g_GlTotal.buffer_upload_bytes / n, g_GlTotal.uniform_updates / n, g_GlTotal.state_skipped / n);
+}
@@ -0,0 +1,255 @@
+// Tempo de GPU por etapa do quadro. Veja gpu_profiler.h.
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "gpu_profiler.h"
+#include "gl_debug.h"
+#include "stats.h"
+
+// Quadros em voo: as consultas de um quadro são reutilizadas (e lidas)
+// GPU_PROFILER_FRAMES quadros depois.
+static const int GPU_PROFILER_FRAMES = 4;
+
+// Quadros lidos entre duas atualizações das médias mostradas no HUD.
+static const int GPU_PROFILER_AVERAGE_FRAMES = 60;
+
+struct GpuScope
+{
+    int pass;
+    size_t begin; // Índices das consultas em GpuFrameQueries::queries
+    size_t end;
+};
+
+struct GpuFrameQueries
+{
+    std::vector<GLuint> queries; // Criadas sob demanda e reaproveitadas
+    size_t used;
+    std::vector<GpuScope> scopes;
+    bool pending;
+};
+
+static bool g_GpuProfilerEnabled = false;
+static bool g_GpuInFrame = false;
+static GpuFrameQueries g_GpuFrames[GPU_PROFILER_FRAMES];
+static int g_GpuFrame = 0;
+static size_t g_GpuOpenScope[GPU_PASS_COUNT + 1]; // Consulta de início do trecho aberto de cada etapa
+
+// Tempos de cada quadro lido, GPU_PASS_COUNT + 1 valores por quadro.
+static std::vector<double> g_GpuHistory;
+static unsigned int g_GpuSkipped = 0;
+static double g_GpuWindowSum[GPU_PASS_COUNT + 1];
+static int g_GpuWindowFrames = 0;
+static double g_GpuAverage[GPU_PASS_COUNT + 1];
+
+const char* GpuProfiler_PassName(int pass)
+{
+    static const char* names[GPU_PASS_COUNT + 1] = {
+        "mapa", "alvos", "arma", "jogador", "crosshair", "texto", "quadro"
+    };
+    return (pass >= 0 && pass <= GPU_PASS_COUNT) ? names[pass] : "?";
+}
+
+static size_t RecordTimestamp(GpuFrameQueries& frame)
+{
+    if (frame.used == frame.queries.size())
+    {
+        GLuint query;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+    glQueryCounter(frame.queries[frame.used], GL_TIMESTAMP);
+    return frame.used++;
+}
+
+// Lê os resultados das consultas de um quadro. Se a última ainda não estiver
+// pronta e "wait" for false, o quadro é descartado.
+static void CollectFrame(GpuFrameQueries& frame, bool wait)
+{
+    frame.pending = false;
+    if (frame.used == 0)
+        return;
+
+    if (!wait)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            ++g_GpuSkipped;
+            return;
+        }
+    }
+
+    std::vector<GLuint64> timestamps(frame.used);
+    for (size_t i = 0; i < frame.used; ++i)
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &timestamps[i]);
+
+    double pass_ms[GPU_PASS_COUNT + 1] = { 0.0 };
+    for (size_t i = 0; i < frame.scopes.size(); ++i)
+    {
+        const GpuScope& scope = frame.scopes[i];
+        pass_ms[scope.pass] += (timestamps[scope.end] - timestamps[scope.begin]) / 1.0e6;
+    }
+
+    for (int p = 0; p <= GPU_PASS_COUNT; ++p)
+    {
+        g_GpuHistory.push_back(pass_ms[p]);
+        g_GpuWindowSum[p] += pass_ms[p];
+    }
+    if (++g_GpuWindowFrames == GPU_PROFILER_AVERAGE_FRAMES)
+    {
+        for (int p = 0; p <= GPU_PASS_COUNT; ++p)
+        {
+            g_GpuAverage[p] = g_GpuWindowSum[p] / g_GpuWindowFrames;
+            g_GpuWindowSum[p] = 0.0;
+        }
+        g_GpuWindowFrames = 0;
+    }
+}
+
+void GpuProfiler_Init()
+{
+    for (int i = 0; i < GPU_PROFILER_FRAMES; ++i)
+    {
+        g_GpuFrames[i].used = 0;
+        g_GpuFrames[i].pending = false;
+    }
+    for (int p = 0; p <= GPU_PASS_COUNT; ++p)
+    {
+        g_GpuWindowSum[p] = 0.0;
+        g_GpuAverage[p] = 0.0;
+    }
+    g_GpuFrame = 0;
+    g_GpuProfilerEnabled = true;
+}
+
+bool GpuProfiler_Enabled()
+{
+    return g_GpuProfilerEnabled;
+}
+
+void GpuProfiler_BeginFrame()
+{
+    if (!g_GpuProfilerEnabled)
+        return;
+
+    GpuFrameQueries& frame = g_GpuFrames[g_GpuFrame];
+    if (frame.pending)
+        CollectFrame(frame, false);
+    frame.used = 0;
+    frame.scopes.clear();
+
+    g_GpuInFrame = true;
+    GpuProfiler_Begin(GPU_PASS_COUNT);
+}
+
+void GpuProfiler_EndFrame()
+{
+    if (!g_GpuInFrame)
+        return;
+
+    GpuProfiler_End(GPU_PASS_COUNT);
+    g_GpuInFrame = false;
+    g_GpuFrames[g_GpuFrame].pending = true;
+    g_GpuFrame = (g_GpuFrame + 1) % GPU_PROFILER_FRAMES;
+}
+
+void GpuProfiler_Begin(GpuPass pass)
+{
+    // As etapas também são grupos de depuração (veja gl_debug.h), mesmo sem
+    // o perfil ligado.
+    GL_DEBUG_PUSH_GROUP(GpuProfiler_PassName(pass));
+    if (!g_GpuInFrame)
+        return;
+    g_GpuOpenScope[pass] = RecordTimestamp(g_GpuFrames[g_GpuFrame]);
+}
+
+void GpuProfiler_End(GpuPass pass)
+{
+    GL_DEBUG_POP_GROUP();
+    if (!g_GpuInFrame)
+        return;
+    GpuFrameQueries& frame = g_GpuFrames[g_GpuFrame];
+    GpuScope scope;
+    scope.pass = pass;
+    scope.begin = g_GpuOpenScope[pass];
+    scope.end = RecordTimestamp(frame);
+    frame.scopes.push_back(scope);
+}
+
+double GpuProfiler_AverageMs(int pass)
+{
+    return (pass >= 0 && pass <= GPU_PASS_COUNT) ? g_GpuAverage[pass] : 0.0;
+}
+
+static bool WriteJson(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERRO: não foi possível criar \"%s\".\n", path);
+        return false;
+    }
+
+    const int columns = GPU_PASS_COUNT + 1;
+    size_t frames = g_GpuHistory.size() / columns;
+    fprintf(file, "{\n  \"frames\": %zu,\n  \"skipped_frames\": %u,\n  \"passes\": [\n", frames, g_GpuSkipped);
+    for (int p = 0; p < columns; ++p)
+    {
+        std::vector<double> values(frames);
+        double sum = 0.0;
+        for (size_t f = 0; f < frames; ++f)
+        {
+            values[f] = g_GpuHistory[f * columns + p];
+            sum += values[f];
+        }
+        std::sort(values.begin(), values.end());
+        fprintf(file, "    { \"name\": \"%s\"", GpuProfiler_PassName(p));
+        if (frames > 0)
+            fprintf(file, ", \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, \"max_ms\": %.4f",
+                    sum / frames, Stats_Percentile(values, 0.50), Stats_Percentile(values, 0.95), values.back());
+        fprintf(file, " }%s\n", p + 1 < columns ? "," : "");
+    }
+
+    // Um vetor por quadro, com os tempos na ordem de "passes".
+    fprintf(file, "  ],\n  \"frame_ms\": [\n");
+    for (size_t f = 0; f < frames; ++f)
+    {
+        fprintf(file, "    [");
+        for (int p = 0; p < columns; ++p)
+            fprintf(file, "%s%.4f", p > 0 ? ", " : "", g_GpuHistory[f * columns + p]);
+        fprintf(file, "]%s\n", f + 1 < frames ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    bool ok = fclose(file) == 0;
+    if (ok)
+        printf("Perfil da GPU: %zu quadros gravados em \"%s\"\n", frames, path);
+    return ok;
+}
+
+void GpuProfiler_Finish(const char* json_path)
+{
+    if (!g_GpuProfilerEnabled)
+        return;
+
+    // Os quadros pendentes são lidos do mais antigo para o mais novo.
+    for (int i = 0; i < GPU_PROFILER_FRAMES; ++i)
+    {
+        GpuFrameQueries& frame = g_GpuFrames[(g_GpuFrame + i) % GPU_PROFILER_FRAMES];
+        if (frame.pending)
+            CollectFrame(frame, true);
+        if (!frame.queries.empty())
+            glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+        frame.queries.clear();
+        frame.used = 0;
+    }
+
+    if (json_path != NULL)
+        WriteJson(json_path);
+    g_GpuProfilerEnabled = false;
+    g_GpuInFrame = false;
+}
@@ -0,0 +1,398 @@
+// Sistema de tarefas com roubo de trabalho. Veja jobs.h.
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+#include "jobs.h"
+#include "profiler.h"
+
+struct Job
+{
+    const char* name;
+    JobFunction function;
+    void* data;
+    JobCounter* counter;
+};
+
+// Fila de uma thread. A dona usa o fim e as ladras o início; a trava é
+// disputada só quando há roubo.
+struct JobQueue
+{
+    std::mutex mutex;
+    std::deque<Job> jobs;
+};
+
+// Filas 0..JOBS_MAX_WORKERS-1: trabalhadoras 1..N; a partir de
+// JOBS_MAX_WORKERS: as outras threads que criam tarefas, na ordem em que
+// criaram a primeira.
+static JobQueue g_JobQueues[JOBS_MAX_WORKERS + JOBS_MAX_THREADS];
+static std::vector<std::thread> g_JobWorkers;
+static int g_JobWorkerCount = 0;
+static std::atomic<int> g_JobThreadCount(0);
+
+// Tarefas em alguma fila. As trabalhadoras sem trabalho giram um pouco e
+// depois dormem em g_JobWake; quem cria uma tarefa só as acorda se há
+// alguma dormindo.
+static std::atomic<int> g_JobsQueued(0);
+static std::atomic<int> g_JobsSleeping(0);
+static std::atomic<bool> g_JobsStopping(false);
+static std::mutex g_JobSleepMutex;
+static std::condition_variable g_JobWake;
+
+static std::atomic<uint64_t> g_JobsExecuted(0);
+static std::atomic<uint64_t> g_JobsStolen(0);
+
+// O gancho e o seu "user" são publicados juntos: quem lê o ponteiro vê um
+// par completo. Os pares nunca são liberados (uma trabalhadora pode estar
+// chamando o anterior), e um par já usado é reaproveitado, então a lista só
+// cresce com pares novos.
+struct JobTimingEntry
+{
+    JobTimingHook hook;
+    void* user;
+};
+static std::mutex g_JobTimingMutex;
+static std::deque<JobTimingEntry> g_JobTimingEntries;
+static std::atomic<const JobTimingEntry*> g_JobTiming(NULL);
+
+// Voltas sem trabalho antes de uma trabalhadora dormir.
+static const int JOB_SPIN_ROUNDS = 256;
+
+static thread_local int t_JobQueue = -1;
+static thread_local int t_JobWorker = 0; // 1..N nas trabalhadoras
+
+// Encerra as trabalhadoras ao fim do programa, antes que os std::thread
+// sejam destruídos ainda ativos.
+struct JobWorkersGuard
+{
+    ~JobWorkersGuard() { Jobs_Shutdown(); }
+};
+static JobWorkersGuard g_JobWorkersGuard;
+
+static uint64_t JobNow()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void ExecuteJob(const Job& job)
+{
+    if (job.name == NULL)
+    {
+        job.function(job.data);
+    }
+    else
+    {
+        // Profiler_Now() é 0 sem o perfil da CPU; o gancho de tempo usa o
+        // relógio sempre.
+        uint64_t begin = JobNow();
+#ifdef PROFILER_ENABLED
+        uint64_t profile_begin = Profiler_Now();
+#endif
+        job.function(job.data);
+#ifdef PROFILER_ENABLED
+        Profiler_Record(job.name, profile_begin, Profiler_Now());
+#endif
+        uint64_t end = JobNow();
+        const JobTimingEntry* timing = g_JobTiming.load(std::memory_order_acquire);
+        if (timing != NULL)
+            timing->hook(job.name, t_JobWorker, begin, end, timing->user);
+    }
+    g_JobsExecuted.fetch_add(1, std::memory_order_relaxed);
+    if (job.counter != NULL)
+        job.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+// Fila da thread atual. Uma thread que não é trabalhadora recebe a sua na
+// primeira chamada; depois de JOBS_MAX_THREADS, as demais compartilham a
+// última.
+static int OwnQueue()
+{
+    if (t_JobQueue < 0)
+    {
+        int thread = g_JobThreadCount.load();
+        while (thread < JOBS_MAX_THREADS && !g_JobThreadCount.compare_exchange_weak(thread, thread + 1))
+            ;
+        t_JobQueue = JOBS_MAX_WORKERS + std::min(thread, JOBS_MAX_THREADS - 1);
+    }
+    return t_JobQueue;
+}
+
+// Índice da "position"-ésima fila em uso: primeiro as das trabalhadoras,
+// depois as das outras threads.
+static int QueueAt(int position)
+{
+    return position < g_JobWorkerCount ? position : JOBS_MAX_WORKERS + position - g_JobWorkerCount;
+}
+
+static int QueuePosition(int queue)
+{
+    return queue < JOBS_MAX_WORKERS ? queue : g_JobWorkerCount + queue - JOBS_MAX_WORKERS;
+}
+
+// Retira de "queue" uma tarefa do grupo "counter" (qualquer uma, com NULL),
+// do fim ("back") ou do início da fila.
+static bool TakeFrom(int queue, JobCounter* counter, bool back, Job* job)
+{
+    JobQueue& q = g_JobQueues[queue];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    size_t size = q.jobs.size();
+    for (size_t k = 0; k < size; ++k)
+    {
+        size_t i = back ? size - 1 - k : k;
+        if (counter != NULL && q.jobs[i].counter != counter)
+            continue;
+        *job = q.jobs[i];
+        q.jobs.erase(q.jobs.begin() + i);
+        g_JobsQueued.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+// Retira uma tarefa: primeiro do fim da fila da thread, depois do início das
+// filas das outras, a partir da seguinte. Com "counter", só as desse grupo.
+static bool TakeJob(int queue, JobCounter* counter, Job* job)
+{
+    if (TakeFrom(queue, counter, true, job))
+        return true;
+
+    int queues = g_JobWorkerCount + std::min(g_JobThreadCount.load(), JOBS_MAX_THREADS);
+    int own = QueuePosition(queue);
+    for (int i = 1; i < queues; ++i)
+    {
+        if (TakeFrom(QueueAt((own + i) % queues), counter, false, job))
+        {
+            g_JobsStolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void WorkerThread(int worker)
+{
+    PROFILE_THREAD_NAME("tarefas");
+    t_JobQueue = worker - 1;
+    t_JobWorker = worker;
+    int idle = 0;
+    while (!g_JobsStopping.load(std::memory_order_acquire))
+    {
+        Job job;
+        if (TakeJob(t_JobQueue, NULL, &job))
+        {
+            ExecuteJob(job);
+            idle = 0;
+            continue;
+        }
+        if (++idle < JOB_SPIN_ROUNDS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // g_JobsSleeping e g_JobsQueued são sequencialmente consistentes:
+        // ou quem criou a tarefa vê esta thread dormindo e a acorda, ou
+        // esta thread vê a tarefa antes de dormir.
+        std::unique_lock<std::mutex> lock(g_JobSleepMutex);
+        g_JobsSleeping.fetch_add(1);
+        while (g_JobsQueued.load() == 0 && !g_JobsStopping.load())
+            g_JobWake.wait(lock);
+        g_JobsSleeping.fetch_sub(1);
+        idle = 0;
+    }
+}
+
+void Jobs_Init(int workers)
+{
+    Jobs_Shutdown();
+    if (workers < 0)
+        workers = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+    workers = std::min(workers, JOBS_MAX_WORKERS);
+
+    g_JobsStopping.store(false);
+    g_JobWorkerCount = workers;
+    g_JobsExecuted.store(0);
+    g_JobsStolen.store(0);
+    for (int i = 1; i <= workers; ++i)
+        g_JobWorkers.push_back(std::thread(WorkerThread, i));
+}
+
+void Jobs_Shutdown()
+{
+    if (g_JobWorkers.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(g_JobSleepMutex);
+        g_JobsStopping.store(true);
+    }
+    g_JobWake.notify_all();
+    for (size_t i = 0; i < g_JobWorkers.size(); ++i)
+        g_JobWorkers[i].join();
+    g_JobWorkers.clear();
+    g_JobWorkerCount = 0;
+}
+
+int Jobs_WorkerCount()
+{
+    return g_JobWorkerCount;
+}
+
+void Jobs_Submit(const char* name, JobFunction function, void* data, JobCounter* counter)
+{
+    Job job = { name, function, data, counter };
+    if (counter != NULL)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    JobQueue& queue = g_JobQueues[OwnQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(job);
+    }
+    g_JobsQueued.fetch_add(1);
+    if (g_JobsSleeping.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(g_JobSleepMutex);
+        g_JobWake.notify_one();
+    }
+}
+
+void Jobs_Wait(JobCounter* counter)
+{
+    int queue = OwnQueue();
+    while (counter->pending.load(std::memory_order_acquire) > 0)
+    {
+        Job job;
+        if (TakeJob(queue, counter, &job))
+            ExecuteJob(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+struct JobRange
+{
+    JobRangeFunction function;
+    void* data;
+    size_t begin;
+    size_t end;
+};
+
+static void RunRange(void* data)
+{
+    JobRange* range = static_cast<JobRange*>(data);
+    range->function(range->begin, range->end, range->data);
+}
+
+void Jobs_ParallelFor(const char* name, size_t count, size_t grain, JobRangeFunction function, void* data)
+{
+    if (count == 0)
+        return;
+    grain = std::max<size_t>(grain, 1);
+
+    // Mais blocos que threads, para que as mais rápidas roubem o restante.
+    size_t chunks = std::min((count + grain - 1) / grain, (size_t)(g_JobWorkerCount + 1) * 4);
+    chunks = std::min<size_t>(chunks, JOBS_MAX_CHUNKS);
+    if (chunks <= 1 || g_JobWorkerCount == 0)
+    {
+        function(0, count, data);
+        return;
+    }
+
+    JobRange ranges[JOBS_MAX_CHUNKS];
+    JobCounter counter;
+    for (size_t c = 0; c < chunks; ++c)
+    {
+        ranges[c].function = function;
+        ranges[c].data = data;
+        ranges[c].begin = count * c / chunks;
+        ranges[c].end = count * (c + 1) / chunks;
+    }
+    // Criados do último para o primeiro: a própria thread retira do fim da
+    // fila, então segue na ordem dos índices depois do primeiro bloco.
+    for (size_t c = chunks - 1; c > 0; --c)
+        Jobs_Submit(name, RunRange, &ranges[c], &counter);
+    RunRange(&ranges[0]);
+    Jobs_Wait(&counter);
+}
+
+void Jobs_SetTimingHook(JobTimingHook hook, void* user)
+{
+    if (hook == NULL)
+    {
+        g_JobTiming.store(NULL, std::memory_order_release);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_JobTimingMutex);
+    const JobTimingEntry* timing = NULL;
+    for (size_t i = 0; i < g_JobTimingEntries.size() && timing == NULL; ++i)
+        if (g_JobTimingEntries[i].hook == hook && g_JobTimingEntries[i].user == user)
+            timing = &g_JobTimingEntries[i];
+    if (timing == NULL)
+    {
+        JobTimingEntry entry = { hook, user };
+        g_JobTimingEntries.push_back(entry);
+        timing = &g_JobTimingEntries.back();
+    }
+    g_JobTiming.store(timing, std::memory_order_release);
+}
+
+void Jobs_GetStats(JobStats* stats)
+{
+    stats->executed = g_JobsExecuted.load();
+    stats->stolen = g_JobsStolen.load();
+}
+
+int JobGraph::Add(const char* name, JobFunction function, void* data)
+{
+    Node node;
+    node.name = name;
+    node.function = function;
+    node.data = data;
+    node.dependencies = 0;
+    node.remaining = 0;
+    node.graph = this;
+    nodes_.push_back(node);
+    return (int)nodes_.size() - 1;
+}
+
+void JobGraph::Depends(int node, int dependency)
+{
+    nodes_[dependency].successors.push_back(node);
+    ++nodes_[node].dependencies;
+}
+
+void JobGraph::RunNode(void* data)
+{
+    Node& node = *static_cast<Node*>(data);
+    node.function(node.data);
+
+    // Os sucessores que ficaram sem dependências pendentes são criados
+    // antes que este nó saia do contador, que assim só chega a zero depois
+    // do último nó.
+    JobGraph& graph = *node.graph;
+    for (size_t i = 0; i < node.successors.size(); ++i)
+    {
+        Node& successor = graph.nodes_[node.successors[i]];
+        bool ready;
+        {
+            std::lock_guard<std::mutex> lock(graph.graph_mutex_);
+            ready = --successor.remaining == 0;
+        }
+        if (ready)
+            Jobs_Submit(successor.name, RunNode, &successor, &graph.done_);
+    }
+}
+
+void JobGraph::Run()
+{
+    for (size_t i = 0; i < nodes_.size(); ++i)
+        nodes_[i].remaining = nodes_[i].dependencies;
+    for (size_t i = 0; i < nodes_.size(); ++i)
+        if (nodes_[i].dependencies == 0)
+            Jobs_Submit(nodes_[i].name, RunNode, &nodes_[i], &done_);
+    Jobs_Wait(&done_);
+}
@@ -15,9 +15,11 @@
 //  vira
 //    #include <cstdio> // Em C++
 //
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 
 // Headers abaixo são específicos de C++
@@ -32,7 +34,9 @@
 #include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <atomic>
 #include <mutex>
+#include <thread>
 
 // Headers das bibliotecas OpenGL
 #include <glad/glad.h>   // Criação de contexto OpenGL 3.3
@@ -48,9 +52,32 @@
 #include <stb_image.h>
 
 // Headers locais, definidos na pasta "include/"
-#include "utils.h"
 #include "matrices.h"
 #include "classes.h"
+#include "raycast.h"
+#include "motion.h"
+#include "paths.h"
+#include "rng.h"
+#include "scheduler.h"
+#include "ecs.h"
+#include "systems.h"
+#include "session.h"
+#include "simulation.h"
+#include "stress.h"
+#include "replay.h"
+#include "stats.h"
+#include "offscreen.h"
+#include "capture.h"
+#include "gpu_profiler.h"
+#include "profiler.h"
+#include "gl_stats.h"
+#include "gl_state.h"
+#include "gl_debug.h"
+#include "pacing.h"
+#include "frame_fences.h"
+#include "dynamic_resolution.h"
+#include "triple_buffer.h"
+#include "jobs.h"
 
 // Estrutura que representa um modelo geométrico carregado a partir de um
 // arquivo ".obj". Veja https://en.wikipedia.org/wiki/Wavefront_.obj_file .
@@ -64,6 +91,7 @@ struct ObjModel
     // Veja: https://github.com/syoyo/tinyobjloader
     ObjModel(const char* filename, const char* basepath = NULL, bool triangulate = true)
     {
+        PROFILE_SCOPE("carregar modelo");
         printf("Carregando objetos do arquivo \"%s\"...\n", filename);
 
         // Se basepath == NULL, então setamos basepath como o dirname do
@@ -117,11 +145,6 @@ void LoadCrosshairShader();
 // Carrega Texturas
 void LoadTextureImage(const char* filename);
 
-// Colisões
-bool CheckCollisionWithSphere(const glm::vec4& cameraPos, const Target& target);
-bool CheckCollisionWithWorld(const glm::vec4& cameraPosition);
-bool CheckSphereCollisionWithSphere(const Target& target1, const Target& target2);
-
 // Declaração de funções utilizadas para pilha de matrizes de modelagem.
 void PushMatrix(glm::mat4 M);
 void PopMatrix(glm::mat4& M);
@@ -138,15 +161,27 @@ void LoadShader(const char* filename, GLuint shader_id); // Função utilizada p
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Cria um programa de GPU
 void PrintObjModelInfo(ObjModel*); // Função para debugging
 
-void RenderGameMap(GameMap& gameMap, glm::mat4 view, glm::mat4 projection); // Função para renderizar o mapa
-void DrawTarget(const Target& target); // Função para desenhar um alvo
-void HandleMouseClick(GLFWwindow* window, double xpos, double ypos, glm::mat4 view, glm::mat4 projection);
+void RenderSystem_Draw(World& world, glm::mat4 view, glm::mat4 projection); // Desenha todas as entidades com Renderable
+void LoadTargetMotionShader(); // Carrega o vertex shader que anima os alvos em movimento na GPU
+void UploadTargetMotionInstances(MotionPool& pool); // Envia para a GPU as trajetórias alteradas
+void LoadPathTableTexture(); // Envia para a GPU as tabelas dos formatos de trajetória
+void DrawMovingTargets(MotionPool& pool, double now, glm::mat4 view, glm::mat4 projection); // Desenha todos os alvos em movimento com uma chamada instanciada
+void RenderStressFrame(Simulation& sim, double now, void* window); // Desenha um quadro do teste de carga
+GLFWwindow* CreateGameWindow(bool visible); // Cria a janela e o contexto OpenGL com a GLFW
+void DrawGameScene(SimulationSnapshot& frame); // Desenha o jogo visto da câmera do jogador, sem o HUD
+void DrawCrosshair(); // Desenha a mira no centro da tela
+void DrawHud(GLFWwindow* window, const SimulationSnapshot& frame); // Desenha o texto do HUD
+void RunOffscreenBenchmark(GLFWwindow* window, int width, int height, int frames); // Modo --offscreen
+glm::vec4 ViewCameraPosition(const glm::vec4& position, const glm::vec4& view_vector, bool third_person); // Posição da câmera virtual
+struct PlayerControls;
+void LatchControls(PlayerControls* controls); // Copia as entradas atuais do jogador para a simulação
+void StepSimulation(double now, PlayerControls& controls); // Avança a simulação um passo
+void PublishSnapshot(); // Publica o estado atual da simulação para o desenho
+void SimulationThread(); // Thread da simulação (veja g_SimThreadRunning)
+void RecordInputEvent(int type, int code, int scancode, int action, int mods, double x, double y, float time); // Grava um evento de entrada (--record)
+float InputEventTime(); // Instante do evento de entrada atual, no relógio da simulação
+void ReplayInputEvents(GLFWwindow* window, uint32_t step, size_t* next); // Reproduz os eventos gravados até o passo "step" (--replay)
 glm::vec4 ScreenToWorld(GLFWwindow* window, double xpos, double ypos, glm::mat4 view, glm::mat4 projection);
-bool IsTargetHit(const Target& target, const glm::vec4& cameraPos, const glm::vec4& rayDir, glm::mat4 view, glm::mat4 projection);
-void SpawnTarget();
-void SpawnTarget_mov();
-float RandomFloat(float min, float max);
-void UpdateCountdown();
 
 //funções de renderização de objetos controlados pelo jogador
 void RenderGun(glm::vec4 camera_up_vector, glm::vec4 camera_view_vector,glm::vec4 camera_position_c);
@@ -167,6 +202,9 @@ void TextRendering_PrintMatrixVectorProductDivW(GLFWwindow* window, glm::mat4 M,
 // Funções abaixo renderizam como texto na janela OpenGL algumas matrizes e
 // outras informações do programa. Definidas após main().
 void TextRendering_ShowFramesPerSecond(GLFWwindow* window);
+void TextRendering_ShowGpuProfile(GLFWwindow* window);
+void TextRendering_ShowGlStats(GLFWwindow* window);
+void TextRendering_ShowDynamicResolution(GLFWwindow* window);
 
 // Funções callback para comunicação com o sistema operacional e interação do
 // usuário. Veja mais comentários nas definições das mesmas, abaixo.
@@ -176,6 +214,9 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mode
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void CursorPosCallback(GLFWwindow* window, double xpos, double ypos);
 void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
+void WindowFocusCallback(GLFWwindow* window, int focused);
+void MarkInputEvent(); // Marca uma entrada do usuário para o modo de espera e a medida de latência
+void WindowRefreshCallback(GLFWwindow* window);
 
 // Definimos uma estrutura que armazenará dados necessários para renderizar
 // cada objeto da cena virtual.
@@ -215,18 +256,18 @@ bool g_LeftMouseButtonPressed = false;
 bool g_RightMouseButtonPressed = false; // Análogo para botão direito do mouse
 bool g_MiddleMouseButtonPressed = false; // Análogo para botão do meio do mouse
 
+// Cliques do botão esquerdo ainda não processados pela simulação, com o
+// instante e a direção da câmera do clique. Um clique rápido entre dois
+// quadros não se perde e cada um é tratado no passo do seu instante. Veja
+// StepSimulation().
+std::vector<ShotInput> g_PendingShots;
+
 // Variáveis globais que armazenam a última posição do cursor do mouse, para
 // que possamos calcular quanto que o mouse se movimentou entre dois instantes
 // de tempo. Utilizadas no callback CursorPosCallback() abaixo.
 double g_LastCursorPosX, g_LastCursorPosY;
 double g_LastClickTime = 0.0;
 const double DMG_COOLDOWN = 0.1;
-double lastSpawnTime = 0.0;
-double lastSpawnTime2 = 0.0;
-double lastShotTime = 0.0;
-int countdownTime = 60;
-auto startTime = std::chrono::steady_clock::now();
-std::mutex spawnMutex;
 
 // Variáveis que definem a câmera em coordenadas esféricas, controladas pelo
 // usuário através do mouse (veja função CursorPosCallback()). A posição
@@ -246,7 +287,6 @@ int g_WindowPosX, g_WindowPosY, g_WindowWidth, g_WindowHeight;
 //variavel que controla o movimento
 bool PRESS_W = false, PRESS_A = false, PRESS_S = false, PRESS_D = false, PRESS_SHIFT = false, PRESS_R = false;
 bool press_space = false, press_p = false;
-bool fim_jogo = false;
 // Variáveis que definem um programa de GPU (shaders). Veja função LoadShadersFromFiles().
 GLuint g_GpuProgramID_obj = 0;
 GLint g_model_uniform;
@@ -256,6 +296,22 @@ GLint g_object_id_uniform;
 GLint g_bbox_min_uniform;
 GLint g_bbox_max_uniform;
 
+// Programa de GPU dos alvos em movimento. Veja "shader_vertex_target_mov.glsl".
+GLuint g_GpuProgramID_target_mov = 0;
+GLint g_view_uniform_target_mov;
+GLint g_projection_uniform_target_mov;
+GLint g_object_id_uniform_target_mov;
+GLint g_bbox_min_uniform_target_mov;
+GLint g_bbox_max_uniform_target_mov;
+GLint g_time_uniform_target_mov;
+
+// Textura com as tabelas dos formatos de trajetória. Veja "paths.h".
+GLuint g_PathTableTexture = 0;
+
+// Buffer com os parâmetros das trajetórias, um elemento por slot da MotionPool
+GLuint g_TargetMotionInstanceVBO = 0;
+size_t g_TargetMotionInstanceCapacity = 0;
+
 GLuint g_GpuProgramID_crosshair = 0;
 GLint g_model_uniform_crosshair;
 GLint g_view_uniform_crosshair;
@@ -264,87 +320,309 @@ GLint g_projection_uniform_crosshair;
 // Número de texturas carregadas pela função LoadTextureImage()
 GLuint g_NumLoadedTextures = 0;
 
-// Lista de alvos
-std::vector<Target> targets;
-Player jogador;
- //pontuacao
-int main(int argc, char* argv[])
-{
-    // Nova variável, velocidade
-    float camera_speed = 4.0f;
-    // Nova variável, tempo anterior
-    float prev_time = (float)glfwGetTime();
-    // Nova variável, tempo que passou
-    float delta_t = 0.0f;
-    // Nova variável, gravidade
-    float gravity = 9.8f;
-    // Nova variável, posição do chão
-    float ground_level = 0.5f;
-    // Nova variável, altura do pulo
-    float jump_force = 5.0f;
-
-    // Criação do GameMap
-    GameMap gameMap;
+// Estado do jogo: alvos, objetos do mapa, jogador e pontuação. Veja
+// simulation.h.
+Simulation g_Sim;
 
+// Entradas do jogador lidas pela simulação: teclas, ângulos da câmera e
+// cliques pendentes, copiadas dos globais dos callbacks por LatchControls().
+struct PlayerControls
+{
+    bool forward, backward, left, right, walk, jump;
+    bool restart; // Fica ligado até o passo que reinicia a rodada
+    bool fire;    // Botão esquerdo segurado
+    bool third_person;
+    float camera_theta, camera_phi;
+    std::vector<ShotInput> shots; // Cliques ainda não processados, em ordem
+
+    PlayerControls()
+        : forward(false), backward(false), left(false), right(false), walk(false), jump(false),
+          restart(false), fire(false), third_person(false), camera_theta(0.0f), camera_phi(0.0f) {}
+};
+PlayerControls g_Controls;
+
+// O desenho lê o último snapshot publicado da simulação (veja
+// SimulationSnapshot), e não g_Sim. Sem a thread da simulação os dois lados
+// rodam na thread principal; com ela (o padrão na janela, exceto ao gravar
+// ou reproduzir uma sessão) a simulação avança em SimulationThread(),
+// publicando um snapshot a cada lote de passos, enquanto a thread principal
+// lê os eventos e desenha: a simulação e o envio de comandos ao driver se
+// sobrepõem. As entradas vão para a simulação por g_SimThreadControls, com
+// uma trava usada apenas para copiá-las.
+TripleBuffer<SimulationSnapshot> g_Snapshots;
+uint64_t g_DrawnSnapshot = 0; // Sequência do último snapshot desenhado
+std::atomic<bool> g_SimThreadRunning(false);
+std::mutex g_SimThreadMutex;
+PlayerControls g_SimThreadControls;
+
+// A simulação avança em passos fixos de g_SimStep segundos, contados a
+// partir de zero, independentemente da taxa de quadros. g_SimSteps é o
+// número de passos já simulados e g_SimOrigin o instante (glfwGetTime()) do
+// passo zero.
+double g_SimStep = 1.0 / 120.0;
+uint32_t g_SimSteps = 0;
+double g_SimOrigin = 0.0;
+
+// Sessão gravada com "--record" ou reproduzida com "--replay". Veja replay.h.
+InputLog g_InputLog;
+bool g_Recording = false;
+bool g_Replaying = false;
+float g_ReplayEventTime = 0.0f; // Instante gravado do evento sendo reproduzido
+
+// Arquivo do trace do perfil da CPU (veja profiler.h), gravado com F9 e, se
+// dado com "--trace", ao final do programa.
+const char* g_TracePath = "trace.json";
+
+// No modo de espera (rodada encerrada ou janela sem foco) um quadro só é
+// desenhado quando algo muda na tela. As funções de callback da GLFW marcam
+// aqui que houve uma entrada do usuário ou uma mudança na janela.
+bool g_RedrawRequested = true;
+
+// Latência da entrada: instante (glfwGetTime()) da entrada mais antiga
+// ainda não vista por um quadro, ou negativo se não houve entrada desde o
+// último quadro, e a latência de cada quadro com entradas, do callback até
+// o retorno de glfwSwapBuffers(), em milissegundos. O tempo entre o evento
+// chegar ao sistema e a GLFW entregá-lo não é visível ao programa.
+double g_OldestInputTime = -1.0;
+std::vector<double> g_InputLatencies;
+
+// Tempo máximo de espera por eventos no modo de espera, em segundos; o
+// relógio da rodada e o placar são conferidos a cada espera.
+const double IDLE_WAIT = 0.25;
 
-    // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
-    // sistema operacional, onde poderemos renderizar com OpenGL.
-    int success = glfwInit();
-    if (!success)
+int main(int argc, char* argv[])
+{
+    // Argumentos: "--seed N" fixa a semente da sessão, reproduzindo a mesma
+    // sequência de alvos; "--headless S" simula S segundos de jogo sem
+    // janela, com passo "--step DT" (padrão 1/60 s), e mede passos por
+    // segundo; "--sessions N" executa N sessões independentes em paralelo
+    // (veja session.h), de "--headless S" segundos cada (padrão 60), com as
+    // sementes "--seed" a "--seed" + N - 1, e mede sessões por segundo e a
+    // duração dos passos; "--stress N1,N2,..." executa o teste de carga (veja stress.h),
+    // configurado por "--stress-rate", "--stress-frames", "--stress-moving"
+    // e "--stress-csv", e "--no-window" o executa sem desenhar; "--record F"
+    // grava a sessão no arquivo F e "--replay F" a reproduz, imprimindo as
+    // estatísticas dos tempos de quadro; "--offscreen LxA" desenha
+    // "--frames N" quadros (padrão 600) em um framebuffer de L x A pixels,
+    // sem janela visível, e mede os tempos de CPU e de GPU de cada quadro;
+    // "--capture D" grava os quadros desenhados no diretório D (veja
+    // capture.h), no formato "--capture-format png|raw", um a cada
+    // "--capture-every N" quadros, e "--golden D" os compara com as imagens
+    // de referência do diretório D; "--gpu-profile F" mede o tempo de GPU de
+    // cada etapa do desenho (veja gpu_profiler.h), mostra as médias na tela
+    // e grava os tempos no arquivo JSON F ao final; "--gl-stats F" conta as
+    // chamadas OpenGL de cada quadro (veja gl_stats.h), mostra os contadores
+    // na tela e grava uma linha por quadro no CSV F; "--no-gl-cache"
+    // desliga o cache do estado OpenGL (veja gl_state.h); "--trace F" grava o
+    // trace do perfil da CPU no arquivo F ao final (a tecla F9 o grava a
+    // qualquer momento); "--no-vsync" desliga o vsync, "--fps-cap N" limita
+    // a taxa de quadros a N por segundo e "--no-idle" desliga o modo de
+    // espera (com a rodada encerrada ou a janela sem foco, o programa dorme
+    // até haver um evento e só desenha quando algo muda); "--frames-in-flight
+    // N" limita a N (1 a 3, padrão 2; 0 desliga) os quadros na fila da GPU
+    // (veja frame_fences.h); "--gpu-budget MS" define o tempo de GPU da cena
+    // buscado pela resolução dinâmica (veja dynamic_resolution.h; o padrão é
+    // 80% do intervalo entre quadros da tela ou de "--fps-cap") e
+    // "--no-dynamic-resolution" a desliga; "--no-sim-thread" avança a
+    // simulação na thread principal, entre os quadros, e não em uma thread
+    // própria; "--jobs N" usa N threads trabalhadoras nos sistemas com
+    // muitos alvos (veja jobs.h; o padrão é uma a menos que o número de
+    // núcleos, e 0 executa tudo na thread que chama); qualquer outro
+    // argumento é um modelo .obj extra.
+    PROFILE_THREAD_NAME("principal");
+
+    const char* extra_model = NULL;
+    uint64_t seed = Rng_RandomSeed();
+    double headless_seconds = 0.0;
+    double headless_step = 1.0 / 60.0;
+    int sessions = 0;
+    bool stress = false;
+    bool no_window = false;
+    const char* record_path = NULL;
+    const char* replay_path = NULL;
+    bool offscreen = false;
+    int offscreen_width = 1600;
+    int offscreen_height = 900;
+    int offscreen_frames = 600;
+    StressOptions stress_options;
+    CaptureOptions capture_options;
+    const char* gpu_profile_path = NULL;
+    bool trace_at_exit = false;
+    const char* gl_stats_path = NULL;
+    bool gl_cache = true;
+    bool vsync = true;
+    double fps_cap = 0.0;
+    bool idle_mode = true;
+    int frames_in_flight = 2;
+    double gpu_budget_ms = 0.0;
+    bool dynamic_resolution = true;
+    bool sim_thread = true;
+    int job_workers = -1;
+    for (int i = 1; i < argc; ++i)
     {
-        fprintf(stderr, "ERROR: glfwInit() failed.\n");
-        std::exit(EXIT_FAILURE);
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc)
+            headless_seconds = atof(argv[++i]);
+        else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc)
+            sessions = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc)
+            headless_step = stress_options.step = atof(argv[++i]);
+        else if (strcmp(argv[i], "--stress") == 0 && i + 1 < argc)
+        {
+            stress = true;
+            if (!Stress_ParsePopulations(argv[++i], &stress_options.populations))
+            {
+                fprintf(stderr, "ERROR: --stress espera populações crescentes separadas por vírgula (ex: 1000,10000).\n");
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--stress-rate") == 0 && i + 1 < argc)
+            stress_options.spawn_rate = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--stress-frames") == 0 && i + 1 < argc)
+            stress_options.frames = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--stress-moving") == 0 && i + 1 < argc)
+            stress_options.moving_fraction = std::min(1.0f, std::max(0.0f, (float)atof(argv[++i])));
+        else if (strcmp(argv[i], "--stress-csv") == 0 && i + 1 < argc)
+            stress_options.csv_path = argv[++i];
+        else if (strcmp(argv[i], "--no-window") == 0)
+            no_window = true;
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            record_path = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            replay_path = argv[++i];
+        else if (strcmp(argv[i], "--offscreen") == 0 && i + 1 < argc)
+        {
+            offscreen = true;
+            if (sscanf(argv[++i], "%dx%d", &offscreen_width, &offscreen_height) != 2 ||
+                offscreen_width <= 0 || offscreen_height <= 0)
+            {
+                fprintf(stderr, "ERROR: --offscreen espera a resolução no formato LARGURAxALTURA (ex: 1920x1080).\n");
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            offscreen_frames = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+            capture_options.directory = argv[++i];
+        else if (strcmp(argv[i], "--capture-format") == 0 && i + 1 < argc)
+        {
+            ++i;
+            if (strcmp(argv[i], "png") == 0)
+                capture_options.format = CAPTURE_PNG;
+            else if (strcmp(argv[i], "raw") == 0)
+                capture_options.format = CAPTURE_RAW;
+            else
+            {
+                fprintf(stderr, "ERROR: --capture-format espera \"png\" ou \"raw\".\n");
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--capture-every") == 0 && i + 1 < argc)
+            capture_options.every = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+            capture_options.golden_directory = argv[++i];
+        else if (strcmp(argv[i], "--gpu-profile") == 0 && i + 1 < argc)
+            gpu_profile_path = argv[++i];
+        else if (strcmp(argv[i], "--gl-stats") == 0 && i + 1 < argc)
+            gl_stats_path = argv[++i];
+        else if (strcmp(argv[i], "--no-gl-cache") == 0)
+            gl_cache = false;
+        else if (strcmp(argv[i], "--no-vsync") == 0)
+            vsync = false;
+        else if (strcmp(argv[i], "--fps-cap") == 0 && i + 1 < argc)
+            fps_cap = atof(argv[++i]);
+        else if (strcmp(argv[i], "--no-idle") == 0)
+            idle_mode = false;
+        else if (strcmp(argv[i], "--gpu-budget") == 0 && i + 1 < argc)
+            gpu_budget_ms = atof(argv[++i]);
+        else if (strcmp(argv[i], "--no-dynamic-resolution") == 0)
+            dynamic_resolution = false;
+        else if (strcmp(argv[i], "--no-sim-thread") == 0)
+            sim_thread = false;
+        else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+            job_workers = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+        {
+            frames_in_flight = atoi(argv[++i]);
+            if (frames_in_flight < 0 || frames_in_flight > FRAME_FENCES_MAX)
+            {
+                fprintf(stderr, "ERROR: --frames-in-flight espera um valor de 0 a %d.\n", FRAME_FENCES_MAX);
+                std::exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            g_TracePath = argv[++i];
+            trace_at_exit = true;
+        }
+        else
+            extra_model = argv[i];
     }
-
-    // Definimos o callback para impressão de erros da GLFW no terminal
-    glfwSetErrorCallback(ErrorCallback);
-
-    // Pedimos para utilizar OpenGL versão 3.3 (ou superior)
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-
-    #ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-    #endif
-
-    // Pedimos para utilizar o perfil "core", isto é, utilizaremos somente as
-    // funções modernas de OpenGL.
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // Criamos uma janela do sistema operacional, com 800 colunas e 600 linhas
-    // de pixels, e com título "INF01047 ...".
-    GLFWwindow* window;
-    window = glfwCreateWindow(1600, 900, "INF01047 - Trabalho Final", NULL, NULL);
-    if (!window)
+    if (replay_path != NULL)
     {
-        glfwTerminate();
-        fprintf(stderr, "ERROR: glfwCreateWindow() failed.\n");
+        // A sessão reproduzida define a semente e o passo da simulação.
+        if (!InputLog_Load(&g_InputLog, replay_path))
+            std::exit(EXIT_FAILURE);
+        g_Replaying = true;
+        seed = g_InputLog.seed;
+        g_SimStep = g_InputLog.step;
+    }
+    else if (record_path != NULL)
+    {
+        g_Recording = true;
+        g_InputLog.seed = seed;
+        g_InputLog.step = g_SimStep;
+    }
+    if (offscreen && stress)
+    {
+        fprintf(stderr, "ERROR: --offscreen e --stress não podem ser usados juntos.\n");
         std::exit(EXIT_FAILURE);
     }
+    Rng_SetSessionSeed(seed);
+    printf("Seed: %llu\n", (unsigned long long)seed);
+    Jobs_Init(job_workers);
 
-    // Definimos a função de callback que será chamada sempre que o usuário
-    // pressionar alguma tecla do teclado ...
-    glfwSetKeyCallback(window, KeyCallback);
-    // ... ou clicar os botões do mouse ...
-    glfwSetMouseButtonCallback(window, MouseButtonCallback);
-    // ... ou movimentar o cursor do mouse em cima da janela ...
-    glfwSetCursorPosCallback(window, CursorPosCallback);
-    // ... ou rolar a "rodinha" do mouse.
-    glfwSetScrollCallback(window, ScrollCallback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-
-    // Indicamos que as chamadas OpenGL deverão renderizar nesta janela
-    glfwMakeContextCurrent(window);
+    // No modo headless, nas sessões em lote e no teste de carga sem janela
+    // nem a GLFW é inicializada.
+    if (sessions > 0)
+    {
+        SessionHostOptions session_options;
+        session_options.sessions = sessions;
+        if (headless_seconds > 0.0)
+            session_options.seconds = headless_seconds;
+        session_options.step = headless_step;
+        session_options.seed = seed;
+        SessionHost_Run(session_options);
+        if (trace_at_exit)
+            Profiler_ExportChromeTrace(g_TracePath);
+        return 0;
+    }
+    if (stress && no_window)
+    {
+        Stress_Run(stress_options, NULL, NULL);
+        if (trace_at_exit)
+            Profiler_ExportChromeTrace(g_TracePath);
+        return 0;
+    }
+    if (headless_seconds > 0.0)
+    {
+        Simulation_RunHeadless(headless_seconds, headless_step);
+        if (trace_at_exit)
+            Profiler_ExportChromeTrace(g_TracePath);
+        return 0;
+    }
 
-    // Carregamento de todas funções definidas por OpenGL 3.3, utilizando a
-    // biblioteca GLAD.
-    gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
 
-    // Definimos a função de callback que será chamada sempre que a janela for
-    // redimensionada, por consequência alterando o tamanho do "framebuffer"
-    // (região de memória onde são armazenados os pixels da imagem).
-    glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
-    FramebufferSizeCallback(window, 1600, 900); // Forçamos a chamada do callback acima, para definir g_ScreenRatio.
+    // No modo offscreen o contexto é criado com EGL, sem janela nem display
+    // (veja offscreen.h). Se não for possível, ou fora dele, usamos a GLFW;
+    // no modo offscreen a janela fica invisível.
+    GLFWwindow* window = NULL;
+    bool egl_context = offscreen && Offscreen_CreateContext();
+    if (egl_context)
+        gladLoadGLLoader((GLADloadproc) Offscreen_GetProcAddress);
+    else
+        window = CreateGameWindow(!offscreen);
 
     // Imprimimos no terminal informações sobre a GPU do sistema
     const GLubyte *vendor      = glGetString(GL_VENDOR);
@@ -354,11 +632,16 @@ int main(int argc, char* argv[])
 
     printf("GPU: %s, %s, OpenGL %s, GLSL %s\n", vendor, renderer, glversion, glslversion);
 
+    // Nas builds de depuração os erros OpenGL são informados pelo driver
+    // (veja gl_debug.h).
+    GlDebug_Init(egl_context ? (GLADloadproc) Offscreen_GetProcAddress : (GLADloadproc) glfwGetProcAddress);
+
     // Carregamos os shaders de vértices e de fragmentos que serão utilizados
     // para renderização. Veja slides 180-200 do documento Aula_03_Rendering_Pipeline_Grafico.pdf.
     //
     LoadShadersFromFiles();
     LoadCrosshairShader();
+    LoadTargetMotionShader();
 
     // Carregamos duas imagens para serem utilizadas como textura
     LoadTextureImage("../../data/teste_chao.jpg");      // TextureImage0
@@ -367,6 +650,7 @@ int main(int argc, char* argv[])
     LoadTextureImage("../../data/Color.bmp");  //TextureImage3
     LoadTextureImage("../../data/teste_parede.jpg");  //TextureImage4
     LoadTextureImage("../../data/Mario_Albedo.png");  //TextureImage5
+    LoadPathTableTexture();
 
 
     // Construímos a representação de objetos geométricos através de malhas de triângulos
@@ -387,15 +671,26 @@ int main(int argc, char* argv[])
     ComputeNormals(&playermodel);
     BuildTrianglesAndAddToVirtualScene(&playermodel);
     
-    if ( argc > 1 )
+    if ( extra_model != NULL )
     {
-        ObjModel model(argv[1]);
+        ObjModel model(extra_model);
         BuildTrianglesAndAddToVirtualScene(&model);
     }
 
     // Inicializamos o código para renderização de texto.
     TextRendering_Init();
 
+    // O teste de carga desenha sem esperar o vsync, para medir o envio dos
+    // comandos de desenho, e encerra o programa.
+    if (stress)
+    {
+        glEnable(GL_DEPTH_TEST);
+        glfwSwapInterval(0);
+        Stress_Run(stress_options, RenderStressFrame, window);
+        glfwTerminate();
+        return 0;
+    }
+
     // Habilitamos o Z-buffer. Veja slides 104-116 do documento Aula_09_Projecoes.pdf.
     glEnable(GL_DEPTH_TEST);
 
@@ -404,296 +699,230 @@ int main(int argc, char* argv[])
     //glCullFace(GL_BACK);
     //glFrontFace(GL_CCW);
     
-    // Computamos a posição da câmera utilizando coordenadas esféricas.  As
-    // variáveis g_CameraDistance, g_CameraPhi, e g_CameraTheta são
-    // controladas pelo mouse do usuário. Veja as funções CursorPosCallback()
-    // e ScrollCallback().
-    float r = g_CameraDistance;
-    float y = r*sin(g_CameraPhi);
-    float z = r*cos(g_CameraPhi)*cos(g_CameraTheta);
-    float x = r*cos(g_CameraPhi)*sin(g_CameraTheta);
+    // Cria o mapa e inicia a primeira rodada. A câmera em primeira pessoa é
+    // o jogador, movido pela simulação (veja Simulation_UpdatePlayer()).
+    Simulation_Init(g_Sim, 0.0, Rng_SessionSeed());
+    g_SimOrigin = egl_context ? 0.0 : glfwGetTime();
+    PublishSnapshot();
+
+    // Na reprodução, cada quadro simula exatamente um passo, sem esperar o
+    // vsync, e o tempo de cada quadro é medido.
+    size_t replay_next_event = 0;
+    std::vector<double> frame_times;
+    if (g_Replaying)
+        glfwSwapInterval(0);
+
+    // A captura dos quadros, o perfil da GPU e a contagem das chamadas
+    // OpenGL começam com o contexto OpenGL já criado e os recursos
+    // carregados.
+    if ((capture_options.directory != NULL || capture_options.golden_directory != NULL) &&
+        !Capture_Start(capture_options))
+        std::exit(EXIT_FAILURE);
+    if (gpu_profile_path != NULL)
+        GpuProfiler_Init();
+    if (gl_stats_path != NULL && !GlStats_Install(gl_stats_path))
+        std::exit(EXIT_FAILURE);
+    if (gl_cache)
+        GlState_Install();
+    FrameFences_Init(frames_in_flight);
 
-    // Abaixo definimos as varáveis que efetivamente definem a câmera virtual.
-    // Veja slides 195-227 e 229-234 do documento Aula_08_Sistemas_de_Coordenadas.pdf.
-    glm::vec4 camera_position_c  = glm::vec4(x,y,z,1.0f); // Ponto "c", centro da câmera
-    glm::vec4 camera_lookat_l    = glm::vec4(0.0f,0.0f,0.0f,1.0f); // Ponto "l", para onde a câmera (look-at) estará sempre olhando
-    glm::vec4 camera_view_vector = camera_lookat_l - camera_position_c; // Vetor "view", sentido para onde a câmera está virada
-    glm::vec4 camera_up_vector   = glm::vec4(0.0f,1.0f,0.0f,0.0f); // Vetor "up" fixado para apontar para o "céu" (eito Y global)
-    glm::vec4 camera_position_third_person;
-
-    // Novo vetor, velocidade da câmera 
-    glm::vec4 camera_velocity   = glm::vec4(0.0f,0.0f,0.0f,0.0f);
-    startTime = std::chrono::steady_clock::now();
-    // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
-    while (!glfwWindowShouldClose(window))
+    // A resolução dinâmica só vale na janela: o modo offscreen e a
+    // reprodução medem sempre a resolução pedida.
+    if (dynamic_resolution && !offscreen && !g_Replaying)
     {
-        // Aqui executamos as operações de renderização
-
-        // Definimos a cor do "fundo" do framebuffer como branco.  Tal cor é
-        // definida como coeficientes RGBA: Red, Green, Blue, Alpha; isto é:
-        // Vermelho, Verde, Azul, Alpha (valor de transparência).
-        // Conversaremos sobre sistemas de cores nas aulas de Modelos de Iluminação.
-        //
-        //           R     G     B     A
-        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        if (gpu_budget_ms <= 0.0)
+        {
+            const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+            double rate = fps_cap > 0.0 ? fps_cap : (mode != NULL && mode->refreshRate > 0 ? mode->refreshRate : 60.0);
+            gpu_budget_ms = 0.8 * 1000.0 / rate;
+        }
+        DynamicResolution_Init(gpu_budget_ms, 0.5f);
+    }
 
-        // "Pintamos" todos os pixels do framebuffer com a cor definida acima,
-        // e também resetamos todos os pixels do Z-buffer (depth buffer).
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // O modo offscreen desenha um número fixo de quadros, sem o loop da
+    // janela abaixo.
+    if (offscreen)
+        RunOffscreenBenchmark(window, offscreen_width, offscreen_height, offscreen_frames);
+
+    // Ritmo dos quadros: com vsync a troca de buffers espera a tela e, com
+    // "--fps-cap", o limitador de pacing.h espera o instante do próximo
+    // quadro. A reprodução desenha sem esperar (veja acima).
+    FrameLimiter limiter;
+    FrameLimiter_Init(limiter, g_Replaying ? 0.0 : fps_cap);
+    if (!offscreen && !g_Replaying)
+        glfwSwapInterval(vsync ? 1 : 0);
+    int last_hud_state[3] = { -1, -1, -1 };
+    bool idle = false;
+
+    // A gravação e a reprodução de sessões dependem de cada evento cair em
+    // um passo conhecido, então a simulação fica na thread principal.
+    std::thread simulation_thread;
+    if (sim_thread && !offscreen && !g_Recording && !g_Replaying)
+    {
+        g_SimThreadRunning.store(true, std::memory_order_release);
+        simulation_thread = std::thread(SimulationThread);
+    }
 
-        // Pedimos para a GPU utilizar o programa de GPU criado acima (contendo
-        // os shaders de vértice e fragmentos).
-        glUseProgram(g_GpuProgramID_obj);
+    // Ficamos em um loop infinito, renderizando, até que o usuário feche a janela
+    while (!offscreen && !glfwWindowShouldClose(window))
+    {
+        PROFILE_SCOPE("quadro");
 
-        glm::mat4 view;
-        if (g_ThirdPersonCamera)
+        // Verificamos com o sistema operacional se houve alguma interação do
+        // usuário (teclado, mouse, ...). Caso positivo, as funções de callback
+        // definidas anteriormente usando glfwSet*Callback() serão chamadas
+        // pela biblioteca GLFW. Para que a câmera desenhada use a entrada
+        // mais recente, a espera pelo próximo quadro (limitador ou modo de
+        // espera, em que a thread dorme até o próximo evento ou por no máximo
+        // IDLE_WAIT segundos) vem antes da leitura dos eventos, e não depois
+        // da troca de buffers.
+        if (idle)
         {
-            // Distância da câmera em terceira pessoa
-            float third_person_distance = 1.0f;
-
-            // Calcule a posição da câmera em terceira pessoa
-            camera_position_third_person = camera_position_c - third_person_distance * (camera_view_vector/norm(camera_view_vector));
-            camera_position_third_person.y += 0.5f; // Ajuste a altura da câmera em terceira pessoa
-            camera_position_third_person.x -= 0.5f; 
-            // Verifique se a câmera está abaixo da altura mínima permitida
-            if (camera_position_third_person.y < 0.5f)
-            {
-                camera_position_third_person.y = 0.5f;
-            }
-
-            view = Matrix_Camera_View(camera_position_third_person, camera_view_vector, camera_up_vector);
-            RenderPlayer(camera_position_c, camera_view_vector, camera_up_vector);
+            PROFILE_SCOPE("espera");
+            glfwWaitEventsTimeout(IDLE_WAIT);
         }
         else
         {
-            view = Matrix_Camera_View(camera_position_c, camera_view_vector, camera_up_vector);
+            FrameLimiter_Wait(limiter);
+            PROFILE_SCOPE("entrada");
+            glfwPollEvents();
         }
+        double frame_start = glfwGetTime();
 
-        // Agora computamos a matriz de Projeção.
-        glm::mat4 projection;
-
-        // Note que, no sistema de coordenadas da câmera, os planos near e far
-        // estão no sentido negativo! Veja slides 176-204 do documento Aula_09_Projecoes.pdf.
-        float nearplane = -0.01f;  // Posição do "near plane"
-        float farplane  = -30.0f; // Posição do "far plane"
-
-        // Projeção Perspectiva.
-        // Para definição do field of view (FOV), veja slides 205-215 do documento Aula_09_Projecoes.pdf.
-        float field_of_view = 3.141592 / 2.5f;
-        projection = Matrix_Perspective(field_of_view, g_ScreenRatio, nearplane, farplane);
-
-
-        glm::mat4 model = Matrix_Identity(); // Transformação identidade de modelagem
-
-        // Enviamos as matrizes "view" e "projection" para a placa de vídeo
-        // (GPU). Veja o arquivo "shader_vertex.glsl", onde estas são
-        // efetivamente aplicadas em todos os pontos.
-        glUniformMatrix4fv(g_view_uniform       , 1 , GL_FALSE , glm::value_ptr(view));
-        glUniformMatrix4fv(g_projection_uniform , 1 , GL_FALSE , glm::value_ptr(projection));
-
-        #define SPHERE 0
-        #define SPHERE_PARADA 1
-        #define PLANE  2
-        #define GUN 3
-        #define PLANE_PAREDE 4
-        #define MARIO 5
-        
-        // Remove alvos expirados
-        targets.erase(
-            std::remove_if(targets.begin(), targets.end(), [](const Target& target) {
-                return target.ShouldBeRemoved();
-            }),
-            targets.end()
-        );
-
-        // Renderiza os alvos
-        for (auto& target : targets) {
-            if (target.IsAlive()) {
-                if (target.GetType() == 1) {
-                    target.UpdatePosition();
-                }
-                DrawTarget(target);
-                if (CheckCollisionWithSphere(camera_position_c, target)) {
-                    // Calcule a direção oposta à colisão
-                    glm::vec4 posicao_target = glm::vec4(target.GetX(), target.GetY(), target.GetZ(), 1.0f);
-                    glm::vec4 direction = (camera_position_c - posicao_target)/(norm(camera_position_c - posicao_target));
-                    
-                    // Mova a câmera na direção oposta até que não haja mais colisão
-                    while (CheckCollisionWithSphere(camera_position_c, target)) {
-                        camera_position_c += glm::vec4(direction.x * 0.01f, direction.y * 0.01f, direction.z * 0.01f, 0.0f); // Ajuste o valor 0.01f conforme necessário
-                    }
-                }
-                // Verifica colisão entre targets e separa-os
-                for (auto& target2 : targets) {
-                    if (&target != &target2 && target2.IsAlive()) {
-                        if (CheckSphereCollisionWithSphere(target, target2)) {
-                            // Calcule a direção oposta à colisão
-                            glm::vec4 posicao_target1 = glm::vec4(target.GetX(), target.GetY(), target.GetZ(), 1.0f);
-                            glm::vec4 posicao_target2 = glm::vec4(target2.GetX(), target2.GetY(), target2.GetZ(), 1.0f);
-                            glm::vec4 direction = (posicao_target2 - posicao_target1) / glm::length(posicao_target2 - posicao_target1);
-                            
-                            // Mova o target2 na direção oposta até que não haja mais colisão
-                            while (CheckSphereCollisionWithSphere(target, target2)) {
-                                target2.SetX(target2.GetX() + direction.x * 0.1f);
-                                target2.SetY(target2.GetY() + direction.y * 0.1f);
-                                target2.SetZ(target2.GetZ() + direction.z * 0.1f); // Ajuste o valor 0.01f conforme necessário
-                            }
-                        }
-                    }
-                }
+        // Cria e remove alvos, encerra a rodada, libera o próximo tiro, trata
+        // as colisões e move o jogador, em todos os passos da simulação
+        // vencidos desde o último quadro. Com a thread da simulação, apenas
+        // entrega a ela as entradas lidas acima.
+        if (g_Replaying)
+        {
+            if (g_SimSteps >= g_InputLog.total_steps)
+                break;
+            {
+                PROFILE_SCOPE("entrada");
+                ReplayInputEvents(window, g_SimSteps, &replay_next_event);
             }
-
+            LatchControls(&g_Controls);
+            StepSimulation((g_SimSteps + 1) * g_SimStep, g_Controls);
+            ++g_SimSteps;
+            PublishSnapshot();
         }
-
-        RenderGun(camera_up_vector, camera_view_vector, camera_position_c);
-       
-        RenderGameMap(gameMap, view, projection);
-        
-        // Copiado do FAQ
-        float current_time = (float)glfwGetTime();
-        delta_t = current_time  - prev_time;
-        prev_time = current_time;
-
-        // Vetores W e U
-        glm::vec4 w_vector = -camera_view_vector / norm(camera_view_vector);
-        glm::vec4 u_vector = crossproduct(camera_up_vector, w_vector) / norm(crossproduct(camera_up_vector, w_vector));
-
-        // Movimentação da câmera
-        if(press_space && camera_position_c.y == ground_level){
-            camera_velocity.y = jump_force;
-            camera_position_c.y += camera_velocity.y * delta_t;
+        else if (simulation_thread.joinable())
+        {
+            std::lock_guard<std::mutex> lock(g_SimThreadMutex);
+            LatchControls(&g_SimThreadControls);
         }
-        // Direção (para normalizar o movimento diagonal)
-        glm::vec4 direction(0.0f);
-
-        if(!fim_jogo){
-            // Verifica se 5 segundos se passaram
-            if (current_time - lastSpawnTime >= RandomFloat(2.0f, 4.0f))
+        else
+        {
+            LatchControls(&g_Controls);
+            uint32_t steps = g_SimSteps;
+            while ((g_SimSteps + 1) * g_SimStep <= glfwGetTime() - g_SimOrigin)
             {
-                std::lock_guard<std::mutex> lock(spawnMutex);
-                // Chame a função SpawnTarget
-                SpawnTarget();
-
-                // Atualize o tempo da última chamada
-                lastSpawnTime = current_time;
+                StepSimulation((g_SimSteps + 1) * g_SimStep, g_Controls);
+                ++g_SimSteps;
             }
-            if (current_time - lastSpawnTime2 >= RandomFloat(6.0f, 10.0f))
+            if (g_SimSteps != steps)
+                PublishSnapshot();
+        }
+        g_Snapshots.Update();
+        SimulationSnapshot& frame = g_Snapshots.ReadBuffer();
+
+        // Modo de espera: com a rodada encerrada, a janela sem foco ou
+        // minimizada, o quadro só é desenhado após uma entrada do usuário,
+        // uma mudança na janela ou uma mudança no placar, no relógio ou no
+        // fim da rodada. A simulação continua avançando normalmente.
+        bool iconified = glfwGetWindowAttrib(window, GLFW_ICONIFIED) != 0;
+        idle = idle_mode && !g_Replaying &&
+                    (frame.round_over || iconified || !glfwGetWindowAttrib(window, GLFW_FOCUSED));
+        int hud_state[3] = { frame.score, frame.countdown, frame.round_over ? 1 : 0 };
+        bool hud_changed = memcmp(hud_state, last_hud_state, sizeof(hud_state)) != 0;
+
+        if (!iconified && (!idle || g_RedrawRequested || hud_changed))
+        {
+            g_RedrawRequested = false;
+            memcpy(last_hud_state, hud_state, sizeof(hud_state));
+            double input_time = g_OldestInputTime;
+            g_OldestInputTime = -1.0;
+
+            // Aqui executamos as operações de renderização. A cena pode ser
+            // desenhada em resolução menor e ampliada (veja
+            // dynamic_resolution.h); a mira e o texto, não.
+            int framebuffer_width, framebuffer_height;
+            glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+            GpuProfiler_BeginFrame();
+            DynamicResolution_BeginScene(framebuffer_width, framebuffer_height);
+            DrawGameScene(frame);
+            DynamicResolution_EndScene();
+
+            DrawCrosshair();
+            DrawHud(window, frame);
+            GpuProfiler_EndFrame();
+
+            // Copia o quadro pronto para a captura, se ligada (--capture).
+            Capture_Frame(framebuffer_width, framebuffer_height);
+            GlStats_EndFrame();
+
+            // O framebuffer onde OpenGL executa as operações de renderização não
+            // é o mesmo que está sendo mostrado para o usuário, caso contrário
+            // seria possível ver artefatos conhecidos como "screen tearing". A
+            // chamada abaixo faz a troca dos buffers, mostrando para o usuário
+            // tudo que foi renderizado pelas funções acima.
+            // Veja o link: https://en.wikipedia.org/w/index.php?title=Multiple_buffering&oldid=793452829#Double_buffering_in_computer_graphics
             {
-                std::lock_guard<std::mutex> lock(spawnMutex);
-                // Chame a função SpawnTarget
-                SpawnTarget_mov();
-
-                // Atualize o tempo da última chamada
-                lastSpawnTime2 = current_time;
+                PROFILE_SCOPE("troca de buffers");
+                glfwSwapBuffers(window);
             }
-        }
+            if (input_time >= 0.0)
+                g_InputLatencies.push_back((glfwGetTime() - input_time) * 1000.0);
 
-        if(PRESS_W)
-            direction += -w_vector;
-        if(PRESS_S)
-            direction += w_vector;
-        if(PRESS_A)
-            direction += -u_vector;
-        if(PRESS_D)
-            direction += u_vector;
-            
-        // Normaliza a direção do movimento
-        if ((norm(direction) * norm(direction)) > 0.0f) {
-            direction /= norm(direction);
-        }
-        direction.y = 0.0f;
-
-        // Atualiza a posição da câmera, considerando o botão shift
-        if(!PRESS_SHIFT){
-            camera_position_c += camera_speed * delta_t * direction;
-        }
-        else{
-            camera_position_c += (camera_speed/2.0f) * delta_t * direction;
-        }
-
-        if(CheckCollisionWithWorld(camera_position_c)){
-            camera_position_c -= camera_speed * delta_t * direction;
-        }
-        if(PRESS_R){
-            startTime = std::chrono::steady_clock::now();
-            fim_jogo = false;
-            jogador.resetScore();
-        }
-        
-        if(g_LeftMouseButtonPressed){
-            if (current_time - lastShotTime >= 0.5) {
-                lastShotTime = current_time;
-                HandleMouseClick(window, g_LastCursorPosX, g_LastCursorPosY, view, projection);
+            // Não deixa a CPU mais do que frames_in_flight quadros à frente
+            // da GPU.
+            {
+                PROFILE_SCOPE("espera da GPU");
+                FrameFences_EndFrame();
             }
         }
 
-        // Cálculo vx,vy,vz e aplicação no view vector
-        float vx = cos(g_CameraPhi) * sin(g_CameraTheta);
-        float vy = sin(g_CameraPhi);
-        float vz = cos(g_CameraTheta) * cos(g_CameraPhi);
-        camera_view_vector = glm::vec4(-vx, vy, -vz, 0.0f);
-
-        if (camera_position_c.y > ground_level)
-        {
-            camera_velocity.y -= gravity * delta_t;
-            camera_position_c.y += camera_velocity.y * delta_t;
-        }
-        if (camera_position_c.y <= ground_level)
-        {
-            camera_position_c.y = ground_level;
-            camera_velocity.y = 0;
-        }
-        if(!press_space && camera_position_c.y == ground_level){
-            camera_velocity.y = 0;
-        }
-
-        // Atualização da posição da câmera
-        float newPlayerX = camera_position_c.x + camera_velocity.x * delta_t;
-        float newPlayerY = camera_position_c.y + camera_velocity.y * delta_t;
-        float newPlayerZ = camera_position_c.z + camera_velocity.z * delta_t;
-
-        // Imprimimos na tela informação sobre o número de quadros renderizados
-        // por segundo (frames per second).
-        TextRendering_ShowFramesPerSecond(window);
-
-        model = Matrix_Identity();
-        view = Matrix_Identity();
-        projection = Matrix_Identity();
-
-        glUniformMatrix4fv(g_view_uniform_crosshair, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(g_projection_uniform_crosshair, 1, GL_FALSE, glm::value_ptr(projection));
-        glUniformMatrix4fv(g_model_uniform_crosshair, 1, GL_FALSE, glm::value_ptr(model));
-        glDisable(GL_DEPTH_TEST);
-        drawCrosshair(g_GpuProgramID_crosshair);
-        glEnable(GL_DEPTH_TEST);
-
-        std::string scoreAtual = "Pontos: " + std::to_string(jogador.getScore());
-        TextRendering_PrintString(window,scoreAtual,-0.95f,0.9f,3.0f);
-        UpdateCountdown();
-        std::string tempo_restante = "Tempo Restante: " + std::to_string(countdownTime);
-        TextRendering_PrintString(window,tempo_restante,-0.95f,0.7f,3.0f);
+        if (g_Replaying)
+            frame_times.push_back((glfwGetTime() - frame_start) * 1000.0);
+    }
 
-        if(fim_jogo){
-            std::string fim = "Fim de Jogo!\nPressione 'R' para reiniciar!";
-            TextRendering_PrintString(window,fim,-0.95f,0.5f,3.0f);
-        }
-        // O framebuffer onde OpenGL executa as operações de renderização não
-        // é o mesmo que está sendo mostrado para o usuário, caso contrário
-        // seria possível ver artefatos conhecidos como "screen tearing". A
-        // chamada abaixo faz a troca dos buffers, mostrando para o usuário
-        // tudo que foi renderizado pelas funções acima.
-        // Veja o link: https://en.wikipedia.org/w/index.php?title=Multiple_buffering&oldid=793452829#Double_buffering_in_computer_graphics
-        glfwSwapBuffers(window);
+    if (simulation_thread.joinable())
+    {
+        g_SimThreadRunning.store(false, std::memory_order_release);
+        simulation_thread.join();
+    }
 
-        // Verificamos com o sistema operacional se houve alguma interação do
-        // usuário (teclado, mouse, ...). Caso positivo, as funções de callback
-        // definidas anteriormente usando glfwSet*Callback() serão chamadas
-        // pela biblioteca GLFW.f
-        glfwPollEvents();
+    Stats_PrintFrames("Latência da entrada até a troca de buffers", g_InputLatencies);
+    FrameFences_Finish();
+    DynamicResolution_Finish();
+    Capture_Finish();
+    GpuProfiler_Finish(gpu_profile_path);
+    GlStats_Finish();
+    if (trace_at_exit)
+        Profiler_ExportChromeTrace(g_TracePath);
+
+    // Fim da gravação ou da reprodução: o estado final identifica a sessão.
+    uint64_t state_hash = Simulation_StateHash(g_Sim);
+    if (g_Recording)
+    {
+        g_InputLog.total_steps = g_SimSteps;
+        g_InputLog.final_state_hash = state_hash;
+        if (InputLog_Save(g_InputLog, record_path))
+            printf("Sessão gravada em \"%s\": %u passos, %zu eventos, estado %016llx\n", record_path,
+                   g_SimSteps, g_InputLog.events.size(), (unsigned long long)state_hash);
+    }
+    if (g_Replaying)
+    {
+        printf("Sessão reproduzida: %u de %u passos, estado %016llx (%s)\n", g_SimSteps, g_InputLog.total_steps,
+               (unsigned long long)state_hash, state_hash == g_InputLog.final_state_hash ? "idêntico ao gravado" : "DIFERENTE do gravado");
+        Stats_PrintFrames("Tempo de quadro", frame_times);
     }
 
     // Finalizamos o uso dos recursos do sistema operacional
-    glfwTerminate();
+    if (egl_context)
+        Offscreen_DestroyContext();
+    else
+        glfwTerminate();
 
     // Fim do programa
     return 0;
@@ -701,6 +930,7 @@ int main(int argc, char* argv[])
 // Função que carrega uma imagem para ser utilizada como textura
 void LoadTextureImage(const char* filename)
 {
+    PROFILE_SCOPE("carregar textura");
     printf("Carregando imagem \"%s\"... ", filename);
 
     // Primeiro fazemos a leitura da imagem do disco
@@ -744,6 +974,8 @@ void LoadTextureImage(const char* filename)
     glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
     glGenerateMipmap(GL_TEXTURE_2D);
     glBindSampler(textureunit, sampler_id);
+    GL_DEBUG_LABEL(GL_TEXTURE, texture_id, filename);
+    GL_DEBUG_LABEL(GL_SAMPLER, sampler_id, filename);
 
     stbi_image_free(data);
 
@@ -778,9 +1010,9 @@ void DrawVirtualObject(const char* object_name)
         (void*)(g_VirtualScene[object_name].first_index * sizeof(GLuint))
     );
 
-    // "Desligamos" o VAO, evitando assim que operações posteriores venham a
-    // alterar o mesmo. Isso evita bugs.
-    glBindVertexArray(0);
+    // O VAO continua ligado: desligá-lo custaria uma chamada a mais por
+    // objeto, e todo código que altera um VAO o liga antes (veja
+    // BuildTrianglesAndAddToVirtualScene()).
 }
 
 // Função que carrega os shaders de vértices e de fragmentos que serão
@@ -815,6 +1047,7 @@ void LoadShadersFromFiles()
 
     // Criamos um programa de GPU utilizando os shaders carregados acima.
     g_GpuProgramID_obj = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+    GL_DEBUG_LABEL(GL_PROGRAM, g_GpuProgramID_obj, "objetos");
 
     // Buscamos o endereço das variáveis definidas dentro do Vertex Shader.
     // Utilizaremos estas variáveis para enviar dados para a placa de vídeo
@@ -862,6 +1095,7 @@ void PopMatrix(glm::mat4& M)
 // especificadas dentro do arquivo ".obj"
 void ComputeNormals(ObjModel* model)
 {
+    PROFILE_SCOPE("calcular normais");
     if ( !model->attrib.normals.empty() )
         return;
 
@@ -928,6 +1162,7 @@ void ComputeNormals(ObjModel* model)
 // Constrói triângulos para futura renderização a partir de um ObjModel.
 void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
 {
+    PROFILE_SCOPE("enviar malha");
     GLuint vertex_array_object_id;
     glGenVertexArrays(1, &vertex_array_object_id);
     glBindVertexArray(vertex_array_object_id);
@@ -1062,6 +1297,10 @@ void BuildTrianglesAndAddToVirtualScene(ObjModel* model)
     // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); // XXX Errado!
     //
 
+    // O VAO recebe o nome do primeiro objeto do modelo.
+    if (!model->shapes.empty())
+        GL_DEBUG_LABEL(GL_VERTEX_ARRAY, vertex_array_object_id, model->shapes[0].name.c_str());
+
     // "Desligamos" o VAO, evitando assim que operações posteriores venham a
     // alterar o mesmo. Isso evita bugs.
     glBindVertexArray(0);
@@ -1099,6 +1338,7 @@ GLuint LoadShader_Fragment(const char* filename)
 // um arquivo GLSL e faz sua compilação.
 void LoadShader(const char* filename, GLuint shader_id)
 {
+    PROFILE_SCOPE("compilar shader");
     // Lemos o arquivo de texto indicado pela variável "filename"
     // e colocamos seu conteúdo em memória, apontado pela variável
     // "shader_string".
@@ -1235,19 +1475,58 @@ void FramebufferSizeCallback(GLFWwindow* window, int width, int height)
     // O cast para float é necessário pois números inteiros são arredondados ao
     // serem divididos!
     g_ScreenRatio = (float)width / height;
+    g_RedrawRequested = true;
+}
+
+// Funções callback chamadas quando a janela ganha ou perde o foco e quando
+// o conteúdo dela precisa ser desenhado de novo.
+void WindowFocusCallback(GLFWwindow* window, int focused)
+{
+    g_RedrawRequested = true;
+}
+
+void WindowRefreshCallback(GLFWwindow* window)
+{
+    g_RedrawRequested = true;
+}
+
+// Chamada pelos callbacks de entrada: o próximo quadro deve ser desenhado e
+// a latência dele é contada a partir desta entrada, se for a mais antiga.
+void MarkInputEvent()
+{
+    g_RedrawRequested = true;
+    if (g_OldestInputTime < 0.0 && !g_Replaying)
+        g_OldestInputTime = glfwGetTime();
 }
 
 // Função callback chamada sempre que o usuário aperta algum dos botões do mouse
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
+    MarkInputEvent();
+    float time = InputEventTime();
+    if (g_Recording)
+    {
+        double x, y;
+        glfwGetCursorPos(window, &x, &y);
+        RecordInputEvent(INPUT_EVENT_MOUSE_BUTTON, button, 0, action, mods, x, y, time);
+    }
+
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
     {
+        // O tiro usa a direção da câmera agora, já com todos os movimentos
+        // do mouse anteriores ao clique.
+        ShotInput shot;
+        shot.time = time;
+        shot.direction = Simulation_ViewVector(g_CameraTheta, g_CameraPhi);
+        g_PendingShots.push_back(shot);
+
         // Se o usuário pressionou o botão esquerdo do mouse, guardamos a
         // posição atual do cursor nas variáveis g_LastCursorPosX e
         // g_LastCursorPosY.  Também, setamos a variável
         // g_LeftMouseButtonPressed como true, para saber que o usuário está
         // com o botão esquerdo pressionado.
-        glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
+        if (window != NULL)
+            glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
         g_LeftMouseButtonPressed = true;
     }
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE)
@@ -1263,7 +1542,8 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
         // g_LastCursorPosY.  Também, setamos a variável
         // g_RightMouseButtonPressed como true, para saber que o usuário está
         // com o botão esquerdo pressionado.
-        glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
+        if (window != NULL)
+            glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
         g_RightMouseButtonPressed = true;
     }
     if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_RELEASE)
@@ -1279,7 +1559,8 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
         // g_LastCursorPosY.  Também, setamos a variável
         // g_MiddleMouseButtonPressed como true, para saber que o usuário está
         // com o botão esquerdo pressionado.
-        glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
+        if (window != NULL)
+            glfwGetCursorPos(window, &g_LastCursorPosX, &g_LastCursorPosY);
         g_MiddleMouseButtonPressed = true;
     }
     if (button == GLFW_MOUSE_BUTTON_MIDDLE && action == GLFW_RELEASE)
@@ -1294,6 +1575,9 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 // cima da janela OpenGL.
 void CursorPosCallback(GLFWwindow* window, double xpos, double ypos)
 {
+    RecordInputEvent(INPUT_EVENT_CURSOR, 0, 0, 0, 0, xpos, ypos, InputEventTime());
+    MarkInputEvent();
+
     // Abaixo executamos o seguinte: caso o botão esquerdo do mouse esteja
     // pressionado, computamos quanto que o mouse se movimento desde o último
     // instante de tempo, e usamos esta movimentação para atualizar os
@@ -1330,6 +1614,8 @@ void CursorPosCallback(GLFWwindow* window, double xpos, double ypos)
 // Função callback chamada sempre que o usuário movimenta a "rodinha" do mouse.
 void ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 {
+    MarkInputEvent();
+
     // Atualizamos a distância da câmera para a origem utilizando a
     // movimentação da "rodinha", simulando um ZOOM.
     g_CameraDistance -= 0.1f*yoffset;
@@ -1356,10 +1642,18 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
             std::exit(100 + i);
     // ====================
 
+    RecordInputEvent(INPUT_EVENT_KEY, key, scancode, action, mod, 0.0, 0.0, InputEventTime());
+    MarkInputEvent();
+
     // Se o usuário pressionar a tecla ESC, fechamos a janela.
-    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
+    // Sem janela (reprodução no modo offscreen) a tecla é ignorada.
+    if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS && window != NULL)
         glfwSetWindowShouldClose(window, GL_TRUE);
 
+    // Grava o trace do perfil da CPU com os últimos quadros.
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS)
+        Profiler_ExportChromeTrace(g_TracePath);
+
     // Troca a câmera pra 3a pessoa (lookat)
     if (key == GLFW_KEY_L && action == GLFW_PRESS)
     {
@@ -1400,7 +1694,7 @@ void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mod)
     {
         PRESS_R = true;
     }
-    if (key == GLFW_KEY_F && action == GLFW_PRESS)
+    if (key == GLFW_KEY_F && action == GLFW_PRESS && window != NULL)
     {
         g_Fullscreen = !g_Fullscreen;
 
@@ -1466,10 +1760,13 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
     // subsequentes da função!
     static float old_seconds = (float)glfwGetTime();
     static int   ellapsed_frames = 0;
-    static char  buffer[20] = "?? fps";
+    static char  buffer[48] = "?? fps";
     static int   numchars = 7;
+    static size_t old_latencies = 0;
+    static double gpu_wait_ms = 0.0;
 
     ellapsed_frames += 1;
+    gpu_wait_ms += FrameFences_LastWaitMs();
 
     // Recuperamos o número de segundos que passou desde a execução do programa
     float seconds = (float)glfwGetTime();
@@ -1479,7 +1776,23 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
 
     if ( ellapsed_seconds > 1.0f )
     {
-        numchars = snprintf(buffer, 20, "%.2f fps", ellapsed_frames / ellapsed_seconds);
+        numchars = snprintf(buffer, 48, "%.2f fps", ellapsed_frames / ellapsed_seconds);
+
+        // Latência média da entrada (veja g_InputLatencies) no mesmo período.
+        size_t latencies = g_InputLatencies.size() - old_latencies;
+        if (latencies > 0)
+        {
+            double sum = 0.0;
+            for (size_t i = old_latencies; i < g_InputLatencies.size(); ++i)
+                sum += g_InputLatencies[i];
+            numchars += snprintf(buffer + numchars, 48 - numchars, ", entrada %.1f ms", sum / latencies);
+        }
+        old_latencies = g_InputLatencies.size();
+
+        // Espera média pelas fences (veja frame_fences.h): perto de zero, a
+        // GPU acompanha a CPU.
+        numchars += snprintf(buffer + numchars, 48 - numchars, ", GPU %.1f ms", gpu_wait_ms / ellapsed_frames);
+        gpu_wait_ms = 0.0;
     
         old_seconds = seconds;
         ellapsed_frames = 0;
@@ -1491,6 +1804,68 @@ void TextRendering_ShowFramesPerSecond(GLFWwindow* window)
     TextRendering_PrintString(window, buffer, 1.0f-(numchars + 1)*charwidth, 1.0f-lineheight, 1.0f);
 }
 
+// Escrevemos na tela, abaixo do fps, o tempo médio de GPU de cada etapa do
+// desenho e do quadro inteiro (--gpu-profile).
+void TextRendering_ShowGpuProfile(GLFWwindow* window)
+{
+    if (!GpuProfiler_Enabled())
+        return;
+
+    float lineheight = TextRendering_LineHeight(window);
+    float charwidth = TextRendering_CharWidth(window);
+
+    for (int pass = 0; pass <= GPU_PASS_COUNT; ++pass)
+    {
+        char buffer[40];
+        int numchars = snprintf(buffer, 40, "GPU %-9s %7.3f ms", GpuProfiler_PassName(pass), GpuProfiler_AverageMs(pass));
+        TextRendering_PrintString(window, buffer, 1.0f-(numchars + 1)*charwidth, 1.0f-(pass + 2)*lineheight, 1.0f);
+    }
+}
+
+// Escrevemos na tela, abaixo do fps e dos tempos de GPU, as chamadas OpenGL
+// do último quadro (--gl-stats).
+void TextRendering_ShowGlStats(GLFWwindow* window)
+{
+    if (!GlStats_Installed())
+        return;
+
+    float lineheight = TextRendering_LineHeight(window);
+    float charwidth = TextRendering_CharWidth(window);
+    int first_line = GpuProfiler_Enabled() ? GPU_PASS_COUNT + 3 : 2;
+
+    const GlFrameStats& stats = GlStats_LastFrame();
+    char lines[8][40];
+    snprintf(lines[0], 40, "GL desenhos   %10u", stats.draw_calls);
+    snprintf(lines[1], 40, "GL triangulos %10llu", (unsigned long long)stats.triangles);
+    snprintf(lines[2], 40, "GL programas  %10u", stats.program_binds);
+    snprintf(lines[3], 40, "GL VAOs       %10u", stats.vao_binds);
+    snprintf(lines[4], 40, "GL texturas   %10u", stats.texture_binds);
+    snprintf(lines[5], 40, "GL envios %4u %7.1f KB", stats.buffer_uploads, stats.buffer_upload_bytes / 1024.0);
+    snprintf(lines[6], 40, "GL uniforms   %10u", stats.uniform_updates);
+    snprintf(lines[7], 40, "GL evitadas   %10u", stats.state_skipped);
+    for (int i = 0; i < 8; ++i)
+    {
+        int numchars = (int)strlen(lines[i]);
+        TextRendering_PrintString(window, lines[i], 1.0f-(numchars + 1)*charwidth, 1.0f-(first_line + i)*lineheight, 1.0f);
+    }
+}
+
+// Escrevemos no canto inferior direito a escala da resolução dinâmica e o
+// tempo de GPU da cena (veja dynamic_resolution.h).
+void TextRendering_ShowDynamicResolution(GLFWwindow* window)
+{
+    if (!DynamicResolution_Enabled())
+        return;
+
+    float lineheight = TextRendering_LineHeight(window);
+    float charwidth = TextRendering_CharWidth(window);
+
+    char buffer[40];
+    int numchars = snprintf(buffer, 40, "Cena %3.0f%% %6.2f ms", DynamicResolution_Scale() * 100.0f,
+                            DynamicResolution_SceneMs());
+    TextRendering_PrintString(window, buffer, 1.0f-(numchars + 1)*charwidth, -1.0f+lineheight/2.0f, 1.0f);
+}
+
 // Função para debugging: imprime no terminal todas informações de um modelo
 // geométrico carregado de um arquivo ".obj".
 // Veja: https://github.com/syoyo/tinyobjloader/blob/22883def8db9ef1f3ffb9b404318e7dd25fdbb51/loader_example.cc#L98
@@ -1669,6 +2044,7 @@ void LoadCrosshairShader() {
         glDeleteProgram(g_GpuProgramID_crosshair);
 
     g_GpuProgramID_crosshair = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+    GL_DEBUG_LABEL(GL_PROGRAM, g_GpuProgramID_crosshair, "mira");
     g_model_uniform_crosshair = glGetUniformLocation(g_GpuProgramID_crosshair, "model"); // Variável da matriz "model"
     g_view_uniform_crosshair = glGetUniformLocation(g_GpuProgramID_crosshair, "view"); // Variável da matriz "view" em shader_vertex.glsl
     g_projection_uniform_crosshair = glGetUniformLocation(g_GpuProgramID_crosshair, "projection"); // Variável da matriz "projection" em shader_vertex.glsl
@@ -1751,27 +2127,49 @@ void drawCrosshair(GLuint shaderProgram) {
 
 }
 
-// Função para renderizar o mapa
-void RenderGameMap(GameMap& gameMap, glm::mat4 view, glm::mat4 projection) {
+// Sistema de renderização: desenha todas as entidades com Renderable, tabela
+// por tabela. Entidades com Transform são posicionadas e escaladas por ele;
+// entidades com StaticModel usam a própria matriz.
+void RenderSystem_Draw(World& world, glm::mat4 view, glm::mat4 projection) {
     glUseProgram(g_GpuProgramID_obj);
     glUniformMatrix4fv(g_view_uniform, 1, GL_FALSE, glm::value_ptr(view));
     glUniformMatrix4fv(g_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
 
-    std::vector<glm::mat4> modelos = gameMap.getModels();
-
-    for(size_t i = 0; i < modelos.size(); ++i){
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(modelos[i]));
+    std::vector<Archetype>& archetypes = world.Archetypes();
+    for (size_t a = 0; a < archetypes.size(); ++a) {
+        Archetype& archetype = archetypes[a];
+        // Entidades com Transform são os alvos; com StaticModel, o mapa.
+        if (archetype.Matches(COMPONENT_TRANSFORM | COMPONENT_RENDERABLE)) {
+            // As matrizes são calculadas antes, em paralelo (veja jobs.h);
+            // só as chamadas OpenGL ficam nesta thread.
+            static std::vector<glm::mat4> models;
+            models.resize(archetype.Size());
+            Jobs_ParallelFor("desenho: matrizes", archetype.Size(), 1024, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const Transform& t = archetype.transforms[i];
+                    models[i] = Matrix_Translate(t.x, t.y, t.z) * Matrix_Scale(t.scale, t.scale, t.scale);
+                }
+            });
 
-        if(i != 0){
-            glUniform1i(g_object_id_uniform, PLANE_PAREDE);
-        } else {
-            glUniform1i(g_object_id_uniform, PLANE);
+            GpuProfiler_Begin(GPU_PASS_TARGETS);
+            for (size_t i = 0; i < archetype.Size(); ++i) {
+                glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(models[i]));
+                glUniform1i(g_object_id_uniform, archetype.renderables[i].object_id);
+                DrawVirtualObject(archetype.renderables[i].mesh);
+            }
+            GpuProfiler_End(GPU_PASS_TARGETS);
+        }
+        else if (archetype.Matches(COMPONENT_STATIC_MODEL | COMPONENT_RENDERABLE)) {
+            GpuProfiler_Begin(GPU_PASS_MAP);
+            for (size_t i = 0; i < archetype.Size(); ++i) {
+                glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(archetype.static_models[i].model));
+                glUniform1i(g_object_id_uniform, archetype.renderables[i].object_id);
+                DrawVirtualObject(archetype.renderables[i].mesh);
+            }
+            GpuProfiler_End(GPU_PASS_MAP);
         }
-        
-        DrawVirtualObject("the_plane");
     }
 
-
     // Desative o shader program se necessário
     glUseProgram(0);
 }
@@ -1834,131 +2232,712 @@ void RenderPlayer(glm::vec4 camera_position_c, glm::vec4 camera_view_vector, glm
     DrawVirtualObject("Mario");
 }
 
-// Função para desenhar o alvo
-void DrawTarget(const Target& target) {
-    if (target.IsAlive()) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = Matrix_Translate(target.GetX(), target.GetY(), target.GetZ()) * Matrix_Scale(0.5f, 0.5f, 0.5f);
+void LoadTargetMotionShader()
+{
+    GLuint vertex_shader_id = LoadShader_Vertex("../../src/shader_vertex_target_mov.glsl");
+    GLuint fragment_shader_id = LoadShader_Fragment("../../src/shader_fragment-tarefa1.glsl");
 
-        glUniformMatrix4fv(g_model_uniform, 1, GL_FALSE, glm::value_ptr(model));
-        if (target.GetType() == 1) {
-            glUniform1i(g_object_id_uniform, SPHERE);
+    // Deletamos o programa de GPU anterior, caso ele exista.
+    if (g_GpuProgramID_target_mov != 0)
+        glDeleteProgram(g_GpuProgramID_target_mov);
+
+    g_GpuProgramID_target_mov = CreateGpuProgram(vertex_shader_id, fragment_shader_id);
+    GL_DEBUG_LABEL(GL_PROGRAM, g_GpuProgramID_target_mov, "alvos em movimento");
+    g_view_uniform_target_mov       = glGetUniformLocation(g_GpuProgramID_target_mov, "view");
+    g_projection_uniform_target_mov = glGetUniformLocation(g_GpuProgramID_target_mov, "projection");
+    g_object_id_uniform_target_mov  = glGetUniformLocation(g_GpuProgramID_target_mov, "object_id");
+    g_bbox_min_uniform_target_mov   = glGetUniformLocation(g_GpuProgramID_target_mov, "bbox_min");
+    g_bbox_max_uniform_target_mov   = glGetUniformLocation(g_GpuProgramID_target_mov, "bbox_max");
+    g_time_uniform_target_mov       = glGetUniformLocation(g_GpuProgramID_target_mov, "time");
+
+    // O fragment shader é o mesmo dos demais objetos, com as mesmas texturas.
+    glUseProgram(g_GpuProgramID_target_mov);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID_target_mov, "TextureImage0"), 0);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID_target_mov, "TextureImage1"), 1);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID_target_mov, "TextureImage2"), 2);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID_target_mov, "TextureImage3"), 3);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID_target_mov, "TextureImage4"), 4);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID_target_mov, "TextureImage5"), 5);
+    glUseProgram(0);
+}
+
+// Envia para a GPU somente os parâmetros das trajetórias que mudaram (alvos
+// criados, destruídos ou removidos). Em um quadro sem esses eventos nada é
+// enviado.
+void UploadTargetMotionInstances(MotionPool& pool)
+{
+    // Por instância: centro e raio (location 3), criação, fase, formato e
+    // flag de alvo ativo (location 4). Veja "shader_vertex_target_mov.glsl".
+    const size_t floats_per_instance = 8;
+    const GLsizei stride = floats_per_instance * sizeof(float);
+
+    if (g_TargetMotionInstanceVBO == 0)
+    {
+        glGenBuffers(1, &g_TargetMotionInstanceVBO);
+        GL_DEBUG_LABEL(GL_BUFFER, g_TargetMotionInstanceVBO, "trajetórias dos alvos");
+
+        // Os atributos por instância são adicionados ao VAO da esfera.
+        glBindVertexArray(g_VirtualScene["the_sphere"].vertex_array_object_id);
+        glBindBuffer(GL_ARRAY_BUFFER, g_TargetMotionInstanceVBO);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, 1);
+        glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (void*)(4 * sizeof(float)));
+        glEnableVertexAttribArray(4);
+        glVertexAttribDivisor(4, 1);
+        glBindVertexArray(0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, g_TargetMotionInstanceVBO);
+
+    std::vector<int> all_slots;
+    std::vector<int>* slots = &pool.dirty_slots;
+    if (pool.Size() > g_TargetMotionInstanceCapacity)
+    {
+        // O buffer cresce em potências de dois e é reenviado por inteiro.
+        g_TargetMotionInstanceCapacity = std::max<size_t>(64, 2 * pool.Size());
+        glBufferData(GL_ARRAY_BUFFER, g_TargetMotionInstanceCapacity * stride, NULL, GL_DYNAMIC_DRAW);
+        for (size_t i = 0; i < pool.Size(); ++i)
+            all_slots.push_back(static_cast<int>(i));
+        slots = &all_slots;
+    }
+
+    for (size_t i = 0; i < slots->size(); ++i)
+    {
+        int slot = (*slots)[i];
+        float instance[floats_per_instance] = {
+            pool.center_x[slot], pool.center_y[slot], pool.center_z[slot], pool.radius[slot],
+            pool.start_time[slot], pool.phase[slot], (float)pool.shape[slot], pool.active[slot]
+        };
+        glBufferSubData(GL_ARRAY_BUFFER, slot * stride, stride, instance);
+    }
+    pool.dirty_slots.clear();
+}
+
+// Envia as tabelas dos formatos de trajetória para a GPU como uma textura
+// RGB de ponto flutuante, com uma linha por formato, e os períodos de cada
+// formato para o vertex shader dos alvos em movimento. O shader lê a textura
+// com texelFetch() e interpola como Paths_Sample(), então a CPU e a GPU
+// calculam a mesma posição.
+void LoadPathTableTexture()
+{
+    int count = Paths_Count();
+    std::vector<float> texels;
+    float periods[PATH_MAX_SHAPES] = {0.0f};
+    for (int shape = 0; shape < count; ++shape)
+    {
+        const PathTable& path = Paths_Get(shape);
+        texels.insert(texels.end(), path.positions.begin(), path.positions.end());
+        periods[shape] = path.period;
+    }
+
+    glGenTextures(1, &g_PathTableTexture);
+
+    GLuint textureunit = g_NumLoadedTextures;
+    glActiveTexture(GL_TEXTURE0 + textureunit);
+    glBindTexture(GL_TEXTURE_2D, g_PathTableTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, PATH_TABLE_SIZE, count, 0, GL_RGB, GL_FLOAT, texels.data());
+    // Sem mipmaps: a textura só é lida com texelFetch(), mas precisa estar
+    // completa.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindSampler(textureunit, 0);
+    GL_DEBUG_LABEL(GL_TEXTURE, g_PathTableTexture, "tabela das trajetórias");
+
+    glUseProgram(g_GpuProgramID_target_mov);
+    glUniform1i(glGetUniformLocation(g_GpuProgramID_target_mov, "path_table"), textureunit);
+    glUniform1fv(glGetUniformLocation(g_GpuProgramID_target_mov, "path_period"), PATH_MAX_SHAPES, periods);
+    glUseProgram(0);
+
+    g_NumLoadedTextures += 1;
+}
+
+// Desenha todos os alvos em movimento com uma única chamada instanciada. A
+// posição de cada um é calculada no vertex shader a partir do uniform "time".
+void DrawMovingTargets(MotionPool& pool, double now, glm::mat4 view, glm::mat4 projection)
+{
+    UploadTargetMotionInstances(pool);
+    if (pool.Size() == 0)
+        return;
+
+    const SceneObject& sphere = g_VirtualScene["the_sphere"];
+
+    glUseProgram(g_GpuProgramID_target_mov);
+    glUniformMatrix4fv(g_view_uniform_target_mov, 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(g_projection_uniform_target_mov, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform1f(g_time_uniform_target_mov, (float)now);
+    glUniform1i(g_object_id_uniform_target_mov, SPHERE);
+    glUniform4f(g_bbox_min_uniform_target_mov, sphere.bbox_min.x, sphere.bbox_min.y, sphere.bbox_min.z, 1.0f);
+    glUniform4f(g_bbox_max_uniform_target_mov, sphere.bbox_max.x, sphere.bbox_max.y, sphere.bbox_max.z, 1.0f);
+
+    glBindVertexArray(sphere.vertex_array_object_id);
+    glDrawElementsInstanced(
+        sphere.rendering_mode,
+        sphere.num_indices,
+        GL_UNSIGNED_INT,
+        (void*)(sphere.first_index * sizeof(GLuint)),
+        static_cast<GLsizei>(pool.Size())
+    );
+
+    // Os demais objetos da cena são desenhados com o programa padrão.
+    glUseProgram(g_GpuProgramID_obj);
+}
+
+// Posição da câmera virtual. Em primeira pessoa é a posição do jogador; em
+// terceira pessoa fica atrás, acima e à esquerda dele.
+glm::vec4 ViewCameraPosition(const glm::vec4& position, const glm::vec4& view_vector, bool third_person)
+{
+    if (!third_person)
+        return position;
+
+    // Distância da câmera em terceira pessoa
+    float third_person_distance = 1.0f;
+
+    // Calcule a posição da câmera em terceira pessoa
+    glm::vec4 camera_position_third_person = position - third_person_distance * (view_vector/norm(view_vector));
+    camera_position_third_person.y += 0.5f; // Ajuste a altura da câmera em terceira pessoa
+    camera_position_third_person.x -= 0.5f;
+    // Verifique se a câmera está abaixo da altura mínima permitida
+    if (camera_position_third_person.y < 0.5f)
+    {
+        camera_position_third_person.y = 0.5f;
+    }
+    return camera_position_third_person;
+}
+
+// Inicializa a GLFW, cria a janela do jogo com um contexto OpenGL 3.3 core
+// corrente, instala os callbacks de entrada e carrega as funções OpenGL.
+GLFWwindow* CreateGameWindow(bool visible)
+{
+    PROFILE_SCOPE("criar janela");
+    // Inicializamos a biblioteca GLFW, utilizada para criar uma janela do
+    // sistema operacional, onde poderemos renderizar com OpenGL.
+    int success = glfwInit();
+    if (!success)
+    {
+        fprintf(stderr, "ERROR: glfwInit() failed.\n");
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Definimos o callback para impressão de erros da GLFW no terminal
+    glfwSetErrorCallback(ErrorCallback);
+
+    // Pedimos para utilizar OpenGL versão 3.3 (ou superior)
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    #ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    #endif
+
+    // Pedimos para utilizar o perfil "core", isto é, utilizaremos somente as
+    // funções modernas de OpenGL.
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    // Nas builds de depuração pedimos um contexto de depuração, em que o
+    // driver gera mais mensagens para a camada de gl_debug.h.
+    #ifdef GL_DEBUG_ENABLED
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+    #endif
+
+    // Criamos uma janela do sistema operacional, com 800 colunas e 600 linhas
+    // de pixels, e com título "INF01047 ...".
+    // A janela invisível do modo offscreen só serve para criar o contexto.
+    if (!visible)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(1600, 900, "INF01047 - Trabalho Final", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        fprintf(stderr, "ERROR: glfwCreateWindow() failed.\n");
+        std::exit(EXIT_FAILURE);
+    }
+
+    // Definimos a função de callback que será chamada sempre que o usuário
+    // pressionar alguma tecla do teclado ... Na reprodução de uma sessão as
+    // entradas vêm do arquivo e as do usuário são ignoradas.
+    if (!g_Replaying)
+    {
+        glfwSetKeyCallback(window, KeyCallback);
+        // ... ou clicar os botões do mouse ...
+        glfwSetMouseButtonCallback(window, MouseButtonCallback);
+        // ... ou movimentar o cursor do mouse em cima da janela ...
+        glfwSetCursorPosCallback(window, CursorPosCallback);
+        // ... ou rolar a "rodinha" do mouse.
+        glfwSetScrollCallback(window, ScrollCallback);
+    }
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // Com o cursor escondido, o movimento "cru" do mouse (sem a aceleração
+    // do sistema operacional), quando disponível, controla a câmera.
+    if (glfwRawMouseMotionSupported())
+        glfwSetInputMode(window, GLFW_RAW_MOUSE_MOTION, GLFW_TRUE);
+
+    // Indicamos que as chamadas OpenGL deverão renderizar nesta janela
+    glfwMakeContextCurrent(window);
+
+    // Carregamento de todas funções definidas por OpenGL 3.3, utilizando a
+    // biblioteca GLAD.
+    gladLoadGLLoader((GLADloadproc) glfwGetProcAddress);
+
+    // Definimos a função de callback que será chamada sempre que a janela for
+    // redimensionada, por consequência alterando o tamanho do "framebuffer"
+    // (região de memória onde são armazenados os pixels da imagem).
+    glfwSetFramebufferSizeCallback(window, FramebufferSizeCallback);
+    FramebufferSizeCallback(window, 1600, 900); // Forçamos a chamada do callback acima, para definir g_ScreenRatio.
+
+    // Ganhar ou perder o foco e precisar redesenhar a janela (ex: ao deixar
+    // de ser coberta) também acordam o modo de espera.
+    glfwSetWindowFocusCallback(window, WindowFocusCallback);
+    glfwSetWindowRefreshCallback(window, WindowRefreshCallback);
+
+    return window;
+}
+
+// Avança a simulação até o instante "now", com as teclas e ângulos da câmera
+// atuais. O tiro sai do centro da câmera virtual na direção do crosshair
+// (centro da tela), isto é, ao longo do view vector. Os cliques pendentes
+// até "now" disparam neste passo; o botão segurado só dispara depois deles.
+// Só lê "controls" e g_Sim, e pode rodar na thread da simulação.
+void StepSimulation(double now, PlayerControls& controls)
+{
+    PROFILE_SCOPE("passo da simulação");
+
+    // Os cliques vencidos são disparados antes dos eventos posteriores a
+    // eles (veja Simulation_FireShots()).
+    size_t due_shots = 0;
+    while (due_shots < controls.shots.size() && controls.shots[due_shots].time <= now)
+        ++due_shots;
+    glm::vec4 shot_origin = ViewCameraPosition(g_Sim.camera_position, g_Sim.camera_view_vector, controls.third_person);
+    Simulation_FireShots(g_Sim, shot_origin, controls.shots.data(), due_shots, now);
+    Simulation_UpdateWorld(g_Sim, now);
+
+    PlayerInput input;
+    input.forward = controls.forward;
+    input.backward = controls.backward;
+    input.left = controls.left;
+    input.right = controls.right;
+    input.walk = controls.walk;
+    input.jump = controls.jump;
+    input.restart = controls.restart;
+    input.fire = controls.fire && due_shots == controls.shots.size();
+    input.camera_theta = controls.camera_theta;
+    input.camera_phi = controls.camera_phi;
+    input.aim_origin = ViewCameraPosition(g_Sim.camera_position, g_Sim.camera_view_vector, controls.third_person);
+    input.aim_direction = g_Sim.camera_view_vector / norm(g_Sim.camera_view_vector);
+    controls.restart = false;
+
+    // Movimento, pulo, gravidade, tiro e reinício da rodada
+    Simulation_UpdatePlayer(g_Sim, input, now, (float)g_SimStep);
+    controls.shots.erase(controls.shots.begin(), controls.shots.begin() + due_shots);
+}
+
+// Copia para "controls" o estado atual das teclas e da câmera, que os
+// callbacks de entrada mudam na thread principal, e passa para ele os
+// cliques e o pedido de reinício ainda não entregues.
+void LatchControls(PlayerControls* controls)
+{
+    controls->forward = PRESS_W;
+    controls->backward = PRESS_S;
+    controls->left = PRESS_A;
+    controls->right = PRESS_D;
+    controls->walk = PRESS_SHIFT;
+    controls->jump = press_space;
+    controls->restart = controls->restart || PRESS_R;
+    controls->fire = g_LeftMouseButtonPressed;
+    controls->third_person = g_ThirdPersonCamera;
+    controls->camera_theta = g_CameraTheta;
+    controls->camera_phi = g_CameraPhi;
+    controls->shots.insert(controls->shots.end(), g_PendingShots.begin(), g_PendingShots.end());
+    g_PendingShots.clear();
+    PRESS_R = false;
+}
+
+// Copia g_Sim para o snapshot livre e o publica para o desenho.
+void PublishSnapshot()
+{
+    Simulation_TakeSnapshot(g_Sim, g_SimSteps * g_SimStep, &g_Snapshots.WriteBuffer());
+    g_Snapshots.Publish();
+}
+
+// Thread da simulação: avança os passos vencidos, com as últimas entradas
+// enviadas pela thread principal, publica um snapshot e dorme até o próximo
+// passo. glfwGetTime() pode ser chamada de qualquer thread.
+void SimulationThread()
+{
+    PROFILE_THREAD_NAME("simulação");
+    PlayerControls controls;
+    while (g_SimThreadRunning.load(std::memory_order_acquire))
+    {
+        // As teclas e a câmera são as últimas enviadas; os cliques e o
+        // reinício ainda não processados se somam aos novos.
+        PlayerControls latest;
+        {
+            std::lock_guard<std::mutex> lock(g_SimThreadMutex);
+            latest = g_SimThreadControls;
+            g_SimThreadControls.shots.clear();
+            g_SimThreadControls.restart = false;
         }
-        else {
-            glUniform1i(g_object_id_uniform, SPHERE_PARADA);
+        latest.shots.insert(latest.shots.begin(), controls.shots.begin(), controls.shots.end());
+        latest.restart = latest.restart || controls.restart;
+        std::swap(controls, latest);
+
+        bool stepped = false;
+        while ((g_SimSteps + 1) * g_SimStep <= glfwGetTime() - g_SimOrigin)
+        {
+            StepSimulation((g_SimSteps + 1) * g_SimStep, controls);
+            ++g_SimSteps;
+            stepped = true;
         }
-    
+        if (stepped)
+            PublishSnapshot();
 
-        DrawVirtualObject("the_sphere"); 
+        double wait = (g_SimSteps + 1) * g_SimStep - (glfwGetTime() - g_SimOrigin);
+        if (wait > 0.0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(wait));
     }
 }
 
-void HandleMouseClick(GLFWwindow* window, double xpos, double ypos, glm::mat4 view, glm::mat4 projection) {
-    glm::vec4 rayDirection = ScreenToWorld(window, xpos, ypos, view, projection);
-    glm::vec4 cameraPosition = glm::inverse(view)[3];
+// Instante do evento de entrada sendo tratado, em segundos desde o passo
+// zero. É a hora em que a GLFW entrega o evento (glfwPollEvents()), não a do
+// sistema operacional. Na reprodução é o instante gravado, para que os
+// cliques caiam nos mesmos passos; por isso também é arredondado para float
+// ao vivo, como na gravação.
+float InputEventTime()
+{
+    if (g_Replaying)
+        return g_ReplayEventTime;
+    return (float)(glfwGetTime() - g_SimOrigin);
+}
+
+// Guarda um evento recebido pelos callbacks de entrada, associado ao próximo
+// passo da simulação, que é o primeiro a vê-lo.
+void RecordInputEvent(int type, int code, int scancode, int action, int mods, double x, double y, float time)
+{
+    if (!g_Recording)
+        return;
+
+    InputEvent event;
+    event.x = x;
+    event.y = y;
+    event.step = g_SimSteps;
+    event.time = time;
+    event.code = code;
+    event.scancode = scancode;
+    event.type = (uint8_t)type;
+    event.action = (uint8_t)action;
+    event.mods = (uint16_t)mods;
+    g_InputLog.events.push_back(event);
+}
 
-    for (auto& target : targets) {
-        if (IsTargetHit(target, cameraPosition, rayDirection, view, projection)) {
-            target.Hit();
-            if(target.GetHealth() <= 0){
-                jogador.addScore(10 + 10*target.GetType());
+// Entrega aos callbacks de entrada os eventos gravados para os passos até
+// "step", na ordem em que foram recebidos.
+void ReplayInputEvents(GLFWwindow* window, uint32_t step, size_t* next)
+{
+    const std::vector<InputEvent>& events = g_InputLog.events;
+    for (; *next < events.size() && events[*next].step <= step; ++*next)
+    {
+        const InputEvent& event = events[*next];
+        g_ReplayEventTime = event.time;
+        switch (event.type)
+        {
+        case INPUT_EVENT_KEY:
+            KeyCallback(window, event.code, event.scancode, event.action, event.mods);
+            break;
+        case INPUT_EVENT_CURSOR:
+            CursorPosCallback(window, event.x, event.y);
+            break;
+        case INPUT_EVENT_MOUSE_BUTTON:
+            MouseButtonCallback(window, event.code, event.action, event.mods);
+            // O callback lê a posição real do cursor ao clicar; usamos a
+            // gravada.
+            if (event.action == GLFW_PRESS && event.code <= GLFW_MOUSE_BUTTON_MIDDLE)
+            {
+                g_LastCursorPosX = event.x;
+                g_LastCursorPosY = event.y;
             }
             break;
         }
     }
 }
 
-glm::vec4 ScreenToWorld(GLFWwindow* window, double xpos, double ypos, glm::mat4 view, glm::mat4 projection) {
-    int width, height;
-    glfwGetWindowSize(window, &width, &height);
+// Desenha o jogo visto da câmera do jogador no snapshot "frame" da
+// simulação: o mapa, os alvos, a arma e o jogador (em terceira pessoa). A
+// mira e o texto do HUD são desenhados à parte, na resolução da janela.
+void DrawGameScene(SimulationSnapshot& frame)
+{
+    PROFILE_SCOPE("desenho");
 
-    float x = (2.0f * static_cast<float>(xpos)) / width - 1.0f;
-    float y = 1.0f - (2.0f * static_cast<float>(ypos)) / height;
-    float z = 1.0f;
+    // As trajetórias alteradas vão para a GPU uma vez por snapshot. Se
+    // algum snapshot foi pulado (a simulação publicou mais de um entre dois
+    // quadros), as alterações dele não estão neste, e todas são reenviadas.
+    if (frame.sequence != g_DrawnSnapshot && frame.sequence != g_DrawnSnapshot + 1)
+    {
+        frame.motion.dirty_slots.clear();
+        for (size_t i = 0; i < frame.motion.Size(); ++i)
+            frame.motion.dirty_slots.push_back(static_cast<int>(i));
+    }
+    g_DrawnSnapshot = frame.sequence;
 
-    glm::vec3 ray_nds(x, y, z);
-    glm::vec4 ray_clip(ray_nds.x, ray_nds.y, -1.0, 1.0);
+    // Abaixo definimos as varáveis que efetivamente definem a câmera virtual.
+    // Veja slides 195-227 e 229-234 do documento Aula_08_Sistemas_de_Coordenadas.pdf.
+    // A direção da câmera vem dos ângulos atuais (g_CameraTheta e
+    // g_CameraPhi), lidos dos eventos logo antes deste quadro, e não do
+    // último passo da simulação, que pode ter sido antes desses eventos.
+    const glm::vec4& camera_position_c  = frame.camera_position; // Ponto "c", centro da câmera
+    const glm::vec4  camera_view_vector = Simulation_ViewVector(g_CameraTheta, g_CameraPhi); // Vetor "view", sentido para onde a câmera está virada
+    const glm::vec4& camera_up_vector   = frame.camera_up_vector; // Vetor "up" fixado para apontar para o "céu" (eito Y global)
+
+    // Definimos a cor do "fundo" do framebuffer como branco.  Tal cor é
+    // definida como coeficientes RGBA: Red, Green, Blue, Alpha; isto é:
+    // Vermelho, Verde, Azul, Alpha (valor de transparência).
+    // Conversaremos sobre sistemas de cores nas aulas de Modelos de Iluminação.
+    //
+    //           R     G     B     A
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
-    glm::vec4 ray_eye = glm::inverse(projection) * ray_clip;
-    ray_eye = glm::vec4(ray_eye.x, ray_eye.y, -1.0, 0.0);
+    // "Pintamos" todos os pixels do framebuffer com a cor definida acima,
+    // e também resetamos todos os pixels do Z-buffer (depth buffer).
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glm::vec4 ray_wor = glm::vec4(glm::inverse(view) * ray_eye);
-    ray_wor = ray_wor/norm(ray_wor);
+    // O texto do HUD e a mira do quadro anterior não desfazem o próprio
+    // estado; ligamos aqui o da cena. Com o cache de gl_state.h as chamadas
+    // que não mudam nada não chegam ao driver.
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glDisable(GL_BLEND);
 
-    return ray_wor;
+    // Pedimos para a GPU utilizar o programa de GPU criado acima (contendo
+    // os shaders de vértice e fragmentos).
+    glUseProgram(g_GpuProgramID_obj);
+
+    glm::mat4 view = Matrix_Camera_View(ViewCameraPosition(frame.camera_position, frame.camera_view_vector, g_ThirdPersonCamera),
+                                        camera_view_vector, camera_up_vector);
+    if (g_ThirdPersonCamera)
+    {
+        GpuProfiler_Begin(GPU_PASS_PLAYER);
+        RenderPlayer(camera_position_c, camera_view_vector, camera_up_vector);
+        GpuProfiler_End(GPU_PASS_PLAYER);
+    }
+
+    // Agora computamos a matriz de Projeção.
+    glm::mat4 projection;
+
+    // Note que, no sistema de coordenadas da câmera, os planos near e far
+    // estão no sentido negativo! Veja slides 176-204 do documento Aula_09_Projecoes.pdf.
+    float nearplane = -0.01f;  // Posição do "near plane"
+    float farplane  = -30.0f; // Posição do "far plane"
+
+    // Projeção Perspectiva.
+    // Para definição do field of view (FOV), veja slides 205-215 do documento Aula_09_Projecoes.pdf.
+    float field_of_view = 3.141592 / 2.5f;
+    projection = Matrix_Perspective(field_of_view, g_ScreenRatio, nearplane, farplane);
+
+    // Enviamos as matrizes "view" e "projection" para a placa de vídeo
+    // (GPU). Veja o arquivo "shader_vertex.glsl", onde estas são
+    // efetivamente aplicadas em todos os pontos.
+    glUniformMatrix4fv(g_view_uniform       , 1 , GL_FALSE , glm::value_ptr(view));
+    glUniformMatrix4fv(g_projection_uniform , 1 , GL_FALSE , glm::value_ptr(projection));
+
+    // Os alvos em movimento são animados e desenhados pela GPU.
+    GpuProfiler_Begin(GPU_PASS_TARGETS);
+    DrawMovingTargets(frame.motion, frame.time, view, projection);
+    GpuProfiler_End(GPU_PASS_TARGETS);
+
+    GpuProfiler_Begin(GPU_PASS_GUN);
+    RenderGun(camera_up_vector, camera_view_vector, camera_position_c);
+    GpuProfiler_End(GPU_PASS_GUN);
+   
+    // Desenha os alvos parados e o mapa
+    RenderSystem_Draw(frame.world, view, projection);
+}
+
+// Desenha a mira no centro da tela, sem teste de profundidade.
+void DrawCrosshair()
+{
+    glm::mat4 model = Matrix_Identity();
+    glm::mat4 view = Matrix_Identity();
+    glm::mat4 projection = Matrix_Identity();
+
+    // A mira usa o próprio programa; sem ele os uniforms abaixo eram enviados
+    // sem programa ligado (GL_INVALID_OPERATION).
+    glUseProgram(g_GpuProgramID_crosshair);
+    glUniformMatrix4fv(g_view_uniform_crosshair, 1, GL_FALSE, glm::value_ptr(view));
+    glUniformMatrix4fv(g_projection_uniform_crosshair, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniformMatrix4fv(g_model_uniform_crosshair, 1, GL_FALSE, glm::value_ptr(model));
+    GpuProfiler_Begin(GPU_PASS_CROSSHAIR);
+    glDisable(GL_DEPTH_TEST);
+    drawCrosshair(g_GpuProgramID_crosshair);
+    GpuProfiler_End(GPU_PASS_CROSSHAIR);
 }
 
-bool IsTargetHit(const Target& target, const glm::vec4& cameraPos, const glm::vec4& rayDir, glm::mat4 view, glm::mat4 projection) {
-    glm::vec4 targetPos(target.GetX(), target.GetY(), target.GetZ(), 1.0f);
+// Modo --offscreen: desenha "frames" quadros do jogo em um framebuffer
+// object de "width" x "height" pixels, avançando a simulação um passo por
+// quadro (com os eventos da sessão, se houver --replay), e imprime as
+// estatísticas dos tempos de CPU e de GPU dos quadros. O tempo de GPU é
+// medido com GL_TIME_ELAPSED em um anel de consultas, lidas alguns quadros
+// depois para não bloquear a CPU esperando a GPU. O primeiro quadro, em que
+// o driver ainda compila shaders e envia texturas, não é medido.
+void RunOffscreenBenchmark(GLFWwindow* window, int width, int height, int frames)
+{
+    GLuint framebuffer, color_buffer, depth_buffer;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &color_buffer);
+    glGenRenderbuffers(1, &depth_buffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_buffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_buffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "ERROR: framebuffer offscreen de %dx%d incompleto.\n", width, height);
+        std::exit(EXIT_FAILURE);
+    }
+    GL_DEBUG_LABEL(GL_FRAMEBUFFER, framebuffer, "offscreen");
+    FramebufferSizeCallback(window, width, height); // Viewport e g_ScreenRatio
+
+    const int QUERY_RING = 4;
+    GLuint queries[QUERY_RING];
+    glGenQueries(QUERY_RING, queries);
 
-    // Transform target position to clip space
-    glm::vec4 clipSpacePos = projection * view * targetPos;
+    printf("Offscreen: %d quadros em %dx%d\n", frames, width, height);
 
-    // Perform perspective divide to get normalized device coordinates (NDC)
-    glm::vec3 ndcSpacePos = glm::vec3(clipSpacePos) / clipSpacePos.w;
+    std::vector<double> cpu_times;
+    std::vector<double> gpu_times;
+    size_t replay_next_event = 0;
+    int measured = 0; // Quadros medidos, e consultas usadas
+    for (int frame = 0; frame <= frames; ++frame)
+    {
+        if (g_Replaying && g_SimSteps >= g_InputLog.total_steps)
+            break;
 
-    // Calculate the distance from the center of the screen in NDC
-    glm::vec2 ndcCenter = glm::vec2(0.0f, 0.0f); // Center of the screen in NDC is (0, 0)
-    glm::vec2 targetNDCPos = glm::vec2(ndcSpacePos.x, ndcSpacePos.y);
-    float dx = targetNDCPos.x - ndcCenter.x;
-    float dy = targetNDCPos.y - ndcCenter.y;
-    float distance = sqrt(dx * dx + dy * dy);
+        std::chrono::steady_clock::time_point frame_start = std::chrono::steady_clock::now();
+        bool measure = frame > 0;
+        GLuint query = queries[measured % QUERY_RING];
 
-    // Consider the radius of the target in NDC
-    float targetRadiusNDC = 0.5f / clipSpacePos.w;
+        // A consulta que vai ser reutilizada é de QUERY_RING quadros atrás
+        // e normalmente já tem o resultado.
+        if (measure && measured >= QUERY_RING)
+        {
+            GLuint64 elapsed_ns = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed_ns);
+            gpu_times.push_back(elapsed_ns / 1.0e6);
+        }
 
-    //printf("Distance from NDC center: %f\n", distance);
-    //printf("Target radius in NDC: %f\n", targetRadiusNDC);
+        if (g_Replaying)
+            ReplayInputEvents(window, g_SimSteps, &replay_next_event);
+        LatchControls(&g_Controls);
+        StepSimulation((g_SimSteps + 1) * g_SimStep, g_Controls);
+        ++g_SimSteps;
+        PublishSnapshot();
+        g_Snapshots.Update();
+
+        if (measure)
+            glBeginQuery(GL_TIME_ELAPSED, query);
+        if (measure)
+            GpuProfiler_BeginFrame();
+        DrawGameScene(g_Snapshots.ReadBuffer());
+        DrawCrosshair();
+        GpuProfiler_EndFrame();
+        if (measure)
+            glEndQuery(GL_TIME_ELAPSED);
+        Capture_Frame(width, height);
+        GlStats_EndFrame();
+        glFlush();
+        FrameFences_EndFrame();
+
+        if (measure)
+        {
+            cpu_times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count());
+            ++measured;
+        }
+        else
+            glFinish();
+    }
 
-    return distance < targetRadiusNDC;
-}
+    // Resultados das consultas dos últimos quadros
+    glFinish();
+    for (int i = std::max(0, measured - QUERY_RING); i < measured; ++i)
+    {
+        GLuint64 elapsed_ns = 0;
+        glGetQueryObjectui64v(queries[i % QUERY_RING], GL_QUERY_RESULT, &elapsed_ns);
+        gpu_times.push_back(elapsed_ns / 1.0e6);
+    }
 
-// Função para gerar um número float aleatório entre min e max em intervalos de 0.5
-float RandomFloat(float min, float max) {
-    int range = static_cast<int>((max - min) * 2) + 1;
-    return min + (rand() % range) * 0.5f;
+    Stats_PrintFrames("Tempo de CPU", cpu_times);
+    Stats_PrintFrames("Tempo de GPU", gpu_times);
+
+    glDeleteQueries(QUERY_RING, queries);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(1, &depth_buffer);
+    glDeleteRenderbuffers(1, &color_buffer);
+    glDeleteFramebuffers(1, &framebuffer);
 }
 
-// Função para spawnar um alvo em uma posição aleatória
-void SpawnTarget() {
-    srand(static_cast<unsigned int>(time(0)));
+// Desenha o texto do HUD: fps, tempos de GPU (--gpu-profile), pontos,
+// tempo restante e o aviso de fim de rodada.
+void DrawHud(GLFWwindow* window, const SimulationSnapshot& frame)
+{
+    PROFILE_SCOPE("texto");
+    GpuProfiler_Begin(GPU_PASS_TEXT);
+
+    // Imprimimos na tela informação sobre o número de quadros renderizados
+    // por segundo (frames per second) e, com --gpu-profile, o tempo de
+    // GPU de cada etapa.
+    TextRendering_ShowFramesPerSecond(window);
+    TextRendering_ShowGpuProfile(window);
+    TextRendering_ShowGlStats(window);
+    TextRendering_ShowDynamicResolution(window);
+
+    std::string scoreAtual = "Pontos: " + std::to_string(frame.score);
+    TextRendering_PrintString(window,scoreAtual,-0.95f,0.9f,3.0f);
+    std::string tempo_restante = "Tempo Restante: " + std::to_string(frame.countdown);
+    TextRendering_PrintString(window,tempo_restante,-0.95f,0.7f,3.0f);
+
+    if(frame.round_over){
+        std::string fim = "Fim de Jogo!\nPressione 'R' para reiniciar!";
+        TextRendering_PrintString(window,fim,-0.95f,0.5f,3.0f);
+    }
 
-    // Gera coordenadas aleatórias para x e z
-    float x = RandomFloat(-6.0f, 6.0f);
-    float z = RandomFloat(-6.0f, 6.0f);
-    float y = RandomFloat(1.0f, 4.0f); // Altura fixa
+    GpuProfiler_End(GPU_PASS_TEXT);
+}
 
-    // Cria um novo alvo
-    Target newTarget(x, y, z, 1, RandomFloat(5.0f,15.0f),1,0);
+// Desenha um quadro do teste de carga: os alvos e o mapa, vistos da câmera
+// da simulação, sem a arma nem o HUD.
+void RenderStressFrame(Simulation& sim, double now, void* window)
+{
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    // Adiciona o novo alvo à lista de alvos
-    targets.push_back(newTarget);
+    glm::mat4 view = Matrix_Camera_View(sim.camera_position, sim.camera_view_vector, sim.camera_up_vector);
+    glm::mat4 projection = Matrix_Perspective(3.141592 / 2.5f, g_ScreenRatio, -0.01f, -30.0f);
+    DrawMovingTargets(sim.motion, now, view, projection);
+    RenderSystem_Draw(sim.world, view, projection);
+
+    glfwSwapBuffers((GLFWwindow*)window);
+    glfwPollEvents();
 }
 
-// Função para spawnar um alvo (em movimento) em uma posição aleatória
-void SpawnTarget_mov() {
-    srand(static_cast<unsigned int>(time(0)));
+glm::vec4 ScreenToWorld(GLFWwindow* window, double xpos, double ypos, glm::mat4 view, glm::mat4 projection) {
+    int width, height;
+    glfwGetWindowSize(window, &width, &height);
+
+    float x = (2.0f * static_cast<float>(xpos)) / width - 1.0f;
+    float y = 1.0f - (2.0f * static_cast<float>(ypos)) / height;
+    float z = 1.0f;
+
+    glm::vec3 ray_nds(x, y, z);
+    glm::vec4 ray_clip(ray_nds.x, ray_nds.y, -1.0, 1.0);
 
-    // Gera coordenadas aleatórias para x e z
-    float x = RandomFloat(-6.0f, 6.0f);
-    float z = RandomFloat(-6.0f, 6.0f);
-    float y = RandomFloat(1.0f, 4.0f); // Altura muda
+    glm::vec4 ray_eye = glm::inverse(projection) * ray_clip;
+    ray_eye = glm::vec4(ray_eye.x, ray_eye.y, -1.0, 0.0);
 
-    // Cria um novo alvo
-    Target newTarget(x, y, z, 1, RandomFloat(10.0f,15.0f),1,1);
+    glm::vec4 ray_wor = glm::vec4(glm::inverse(view) * ray_eye);
+    ray_wor = ray_wor/norm(ray_wor);
 
-    // Adiciona o novo alvo à lista de alvos
-    targets.push_back(newTarget);
+    return ray_wor;
 }
-
-void UpdateCountdown() {
-    auto now = std::chrono::steady_clock::now();
-    std::chrono::duration<float> elapsed = now - startTime;
-    countdownTime = 60 - static_cast<int>(elapsed.count());
-    if (countdownTime < 0) {
-        countdownTime = 0;
-    }
-    if (countdownTime == 0) {
-        fim_jogo = true;
-    }
-}
\ No newline at end of file
@@ -0,0 +1,103 @@
+// Avaliação das trajetórias dos alvos em movimento.
+//
+// Cada alvo percorre um dos formatos de "paths.h". As tabelas desses formatos
+// já são parametrizadas por comprimento de arco, então a fração de volta
+// percorrida é proporcional ao tempo e a posição sai de uma consulta O(1) na
+// tabela compartilhada por todos os alvos do mesmo formato.
+#include <cmath>
+
+#include "motion.h"
+#include "jobs.h"
+#include "paths.h"
+
+static const size_t EVALUATE_GRAIN = 4096;
+
+int MotionPool::Allocate(float cx, float cy, float cz, float r, float start, int path_shape, float phase_offset)
+{
+    int slot;
+    if (!free_slots.empty())
+    {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }
+    else
+    {
+        slot = static_cast<int>(radius.size());
+        center_x.push_back(0.0f);
+        center_y.push_back(0.0f);
+        center_z.push_back(0.0f);
+        radius.push_back(0.0f);
+        start_time.push_back(0.0f);
+        phase.push_back(0.0f);
+        shape.push_back(PATH_CIRCLE);
+        active.push_back(0.0f);
+        pos_x.push_back(0.0f);
+        pos_y.push_back(0.0f);
+        pos_z.push_back(0.0f);
+    }
+
+    center_x[slot] = cx;
+    center_y[slot] = cy;
+    center_z[slot] = cz;
+    radius[slot] = r;
+    start_time[slot] = start;
+    phase[slot] = phase_offset;
+    shape[slot] = path_shape;
+    active[slot] = 1.0f;
+    Motion_Evaluate(*this, slot, start, &pos_x[slot], &pos_y[slot], &pos_z[slot]);
+    dirty_slots.push_back(slot);
+    return slot;
+}
+
+void MotionPool::Deactivate(int slot)
+{
+    if (active[slot] != 0.0f)
+    {
+        active[slot] = 0.0f;
+        dirty_slots.push_back(slot);
+    }
+}
+
+void MotionPool::Release(int slot)
+{
+    Deactivate(slot);
+    radius[slot] = 0.0f;
+    free_slots.push_back(slot);
+}
+
+void Motion_Evaluate(const MotionPool& pool, int i, float now, float* x, float* y, float* z)
+{
+    const PathTable& path = Paths_Get(pool.shape[i]);
+
+    // O tempo decorrido é sempre positivo, então s fica em [0,1).
+    float s = (now - pool.start_time[i] + pool.phase[i]) / path.period;
+    s -= std::floor(s);
+
+    float ux, uy, uz;
+    Paths_Sample(path, s, &ux, &uy, &uz);
+
+    *x = pool.center_x[i] + pool.radius[i]*ux;
+    *y = pool.center_y[i] + pool.radius[i]*uy;
+    *z = pool.center_z[i] + pool.radius[i]*uz;
+}
+
+bool Motion_MayBeNear(const MotionPool& pool, int slot, float x, float y, float z, float distance)
+{
+    // A trajetória inteira está contida na esfera de raio radius*bound em
+    // torno do centro (bound é calculado junto com a tabela do formato).
+    float dx = x - pool.center_x[slot];
+    float dy = y - pool.center_y[slot];
+    float dz = z - pool.center_z[slot];
+    float reach = distance + pool.radius[slot] * Paths_Get(pool.shape[slot]).bound;
+    return dx*dx + dy*dy + dz*dz <= reach*reach;
+}
+
+void Motion_EvaluateBatch(MotionPool& pool, float now)
+{
+    // Cada slot é independente; os blocos de EVALUATE_GRAIN slots são
+    // divididos entre as threads do sistema de tarefas (veja jobs.h).
+    Jobs_ParallelFor("movimento: trajetórias", pool.Size(), EVALUATE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            Motion_Evaluate(pool, static_cast<int>(i), now, &pool.pos_x[i], &pool.pos_y[i], &pool.pos_z[i]);
+    });
+}
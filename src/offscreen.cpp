@@ -0,0 +1,196 @@
+// Contexto OpenGL sem janela via EGL. Veja offscreen.h.
+#include <cstdio>
+
+#include "offscreen.h"
+
+#ifdef __linux__
+
+#include <dlfcn.h>
+#include <stdint.h>
+
+// Somente os tipos e constantes de EGL usados abaixo, para não depender dos
+// headers de EGL na compilação.
+typedef void* EGLDisplay;
+typedef void* EGLConfig;
+typedef void* EGLContext;
+typedef void* EGLSurface;
+typedef int32_t EGLint;
+typedef unsigned int EGLBoolean;
+typedef unsigned int EGLenum;
+
+static const EGLint EGL_NONE                            = 0x3038;
+static const EGLint EGL_SURFACE_TYPE                    = 0x3033;
+static const EGLint EGL_PBUFFER_BIT                     = 0x0001;
+static const EGLint EGL_RENDERABLE_TYPE                 = 0x3040;
+static const EGLint EGL_OPENGL_BIT                      = 0x0008;
+static const EGLint EGL_WIDTH                           = 0x3057;
+static const EGLint EGL_HEIGHT                          = 0x3056;
+static const EGLint EGL_VENDOR                          = 0x3053;
+static const EGLenum EGL_OPENGL_API                     = 0x30A2;
+static const EGLint EGL_CONTEXT_MAJOR_VERSION           = 0x3098;
+static const EGLint EGL_CONTEXT_MINOR_VERSION           = 0x30FB;
+static const EGLint EGL_CONTEXT_OPENGL_PROFILE_MASK     = 0x30FD;
+static const EGLint EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT = 0x0001;
+static const EGLenum EGL_PLATFORM_SURFACELESS_MESA      = 0x31DD;
+
+typedef void* (*PFN_eglGetProcAddress)(const char*);
+typedef EGLDisplay (*PFN_eglGetPlatformDisplayEXT)(EGLenum, void*, const EGLint*);
+typedef EGLDisplay (*PFN_eglGetDisplay)(void*);
+typedef EGLBoolean (*PFN_eglInitialize)(EGLDisplay, EGLint*, EGLint*);
+typedef EGLBoolean (*PFN_eglTerminate)(EGLDisplay);
+typedef EGLBoolean (*PFN_eglBindAPI)(EGLenum);
+typedef EGLBoolean (*PFN_eglChooseConfig)(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*);
+typedef EGLContext (*PFN_eglCreateContext)(EGLDisplay, EGLConfig, EGLContext, const EGLint*);
+typedef EGLBoolean (*PFN_eglDestroyContext)(EGLDisplay, EGLContext);
+typedef EGLSurface (*PFN_eglCreatePbufferSurface)(EGLDisplay, EGLConfig, const EGLint*);
+typedef EGLBoolean (*PFN_eglDestroySurface)(EGLDisplay, EGLSurface);
+typedef EGLBoolean (*PFN_eglMakeCurrent)(EGLDisplay, EGLSurface, EGLSurface, EGLContext);
+typedef const char* (*PFN_eglQueryString)(EGLDisplay, EGLint);
+
+static void* g_EglLibrary = NULL;
+static PFN_eglGetProcAddress g_eglGetProcAddress = NULL;
+static PFN_eglTerminate g_eglTerminate = NULL;
+static PFN_eglDestroyContext g_eglDestroyContext = NULL;
+static PFN_eglDestroySurface g_eglDestroySurface = NULL;
+static PFN_eglMakeCurrent g_eglMakeCurrent = NULL;
+static EGLDisplay g_EglDisplay = NULL;
+static EGLContext g_EglContext = NULL;
+static EGLSurface g_EglSurface = NULL;
+
+bool Offscreen_CreateContext()
+{
+    g_EglLibrary = dlopen("libEGL.so.1", RTLD_NOW | RTLD_LOCAL);
+    if (g_EglLibrary == NULL)
+    {
+        fprintf(stderr, "Offscreen: libEGL.so.1 não encontrada.\n");
+        return false;
+    }
+
+    g_eglGetProcAddress = (PFN_eglGetProcAddress)dlsym(g_EglLibrary, "eglGetProcAddress");
+    g_eglTerminate      = (PFN_eglTerminate)dlsym(g_EglLibrary, "eglTerminate");
+    g_eglDestroyContext = (PFN_eglDestroyContext)dlsym(g_EglLibrary, "eglDestroyContext");
+    g_eglDestroySurface = (PFN_eglDestroySurface)dlsym(g_EglLibrary, "eglDestroySurface");
+    g_eglMakeCurrent    = (PFN_eglMakeCurrent)dlsym(g_EglLibrary, "eglMakeCurrent");
+    PFN_eglGetDisplay eglGetDisplay_ = (PFN_eglGetDisplay)dlsym(g_EglLibrary, "eglGetDisplay");
+    PFN_eglInitialize eglInitialize_ = (PFN_eglInitialize)dlsym(g_EglLibrary, "eglInitialize");
+    PFN_eglBindAPI eglBindAPI_ = (PFN_eglBindAPI)dlsym(g_EglLibrary, "eglBindAPI");
+    PFN_eglChooseConfig eglChooseConfig_ = (PFN_eglChooseConfig)dlsym(g_EglLibrary, "eglChooseConfig");
+    PFN_eglCreateContext eglCreateContext_ = (PFN_eglCreateContext)dlsym(g_EglLibrary, "eglCreateContext");
+    PFN_eglCreatePbufferSurface eglCreatePbufferSurface_ = (PFN_eglCreatePbufferSurface)dlsym(g_EglLibrary, "eglCreatePbufferSurface");
+    PFN_eglQueryString eglQueryString_ = (PFN_eglQueryString)dlsym(g_EglLibrary, "eglQueryString");
+    if (!g_eglGetProcAddress || !g_eglTerminate || !g_eglDestroyContext || !g_eglDestroySurface || !g_eglMakeCurrent ||
+        !eglGetDisplay_ || !eglInitialize_ || !eglBindAPI_ || !eglChooseConfig_ || !eglCreateContext_ ||
+        !eglCreatePbufferSurface_ || !eglQueryString_)
+    {
+        fprintf(stderr, "Offscreen: libEGL incompleta.\n");
+        Offscreen_DestroyContext();
+        return false;
+    }
+
+    // A plataforma "surfaceless" da Mesa não precisa de display; sem ela,
+    // tentamos o display padrão.
+    PFN_eglGetPlatformDisplayEXT eglGetPlatformDisplayEXT_ =
+        (PFN_eglGetPlatformDisplayEXT)g_eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLint major, minor;
+    if (eglGetPlatformDisplayEXT_ != NULL)
+        g_EglDisplay = eglGetPlatformDisplayEXT_(EGL_PLATFORM_SURFACELESS_MESA, NULL, NULL);
+    if (g_EglDisplay == NULL || !eglInitialize_(g_EglDisplay, &major, &minor))
+    {
+        g_EglDisplay = eglGetDisplay_(NULL);
+        if (g_EglDisplay == NULL || !eglInitialize_(g_EglDisplay, &major, &minor))
+        {
+            fprintf(stderr, "Offscreen: nenhum display EGL disponível.\n");
+            g_EglDisplay = NULL;
+            Offscreen_DestroyContext();
+            return false;
+        }
+    }
+    eglBindAPI_(EGL_OPENGL_API);
+
+    const EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    // Com EGL_KHR_no_config_context e EGL_KHR_surfaceless_context o contexto
+    // não precisa de configuração nem de superfície: todo o desenho é feito
+    // em framebuffer objects. Caso contrário, usamos um pbuffer 1x1.
+    g_EglContext = eglCreateContext_(g_EglDisplay, NULL, NULL, context_attributes);
+    if (g_EglContext == NULL || !g_eglMakeCurrent(g_EglDisplay, NULL, NULL, g_EglContext))
+    {
+        if (g_EglContext != NULL)
+            g_eglDestroyContext(g_EglDisplay, g_EglContext);
+        g_EglContext = NULL;
+
+        const EGLint config_attributes[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_NONE
+        };
+        const EGLint pbuffer_attributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        EGLConfig config;
+        EGLint num_configs = 0;
+        if (eglChooseConfig_(g_EglDisplay, config_attributes, &config, 1, &num_configs) && num_configs > 0)
+        {
+            g_EglSurface = eglCreatePbufferSurface_(g_EglDisplay, config, pbuffer_attributes);
+            g_EglContext = eglCreateContext_(g_EglDisplay, config, NULL, context_attributes);
+        }
+        if (g_EglSurface == NULL || g_EglContext == NULL ||
+            !g_eglMakeCurrent(g_EglDisplay, g_EglSurface, g_EglSurface, g_EglContext))
+        {
+            fprintf(stderr, "Offscreen: não foi possível criar um contexto OpenGL 3.3 core com EGL.\n");
+            Offscreen_DestroyContext();
+            return false;
+        }
+    }
+
+    printf("Offscreen: EGL %d.%d (%s)\n", major, minor, eglQueryString_(g_EglDisplay, EGL_VENDOR));
+    return true;
+}
+
+void* Offscreen_GetProcAddress(const char* name)
+{
+    return g_eglGetProcAddress != NULL ? g_eglGetProcAddress(name) : NULL;
+}
+
+void Offscreen_DestroyContext()
+{
+    if (g_EglDisplay != NULL)
+    {
+        g_eglMakeCurrent(g_EglDisplay, NULL, NULL, NULL);
+        if (g_EglContext != NULL)
+            g_eglDestroyContext(g_EglDisplay, g_EglContext);
+        if (g_EglSurface != NULL)
+            g_eglDestroySurface(g_EglDisplay, g_EglSurface);
+        g_eglTerminate(g_EglDisplay);
+    }
+    g_EglDisplay = NULL;
+    g_EglContext = NULL;
+    g_EglSurface = NULL;
+
+    if (g_EglLibrary != NULL)
+        dlclose(g_EglLibrary);
+    g_EglLibrary = NULL;
+    g_eglGetProcAddress = NULL;
+}
+
+#else
+
+bool Offscreen_CreateContext()
+{
+    fprintf(stderr, "Offscreen: EGL só é suportado no Linux.\n");
+    return false;
+}
+
+void* Offscreen_GetProcAddress(const char* name)
+{
+    return NULL;
+}
+
+void Offscreen_DestroyContext()
+{
+}
+
+#endif
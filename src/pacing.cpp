@@ -0,0 +1,86 @@
+// Limite da taxa de quadros. Veja pacing.h.
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "pacing.h"
+#include "profiler.h"
+
+static const std::chrono::steady_clock::time_point g_PacingEpoch = std::chrono::steady_clock::now();
+
+// Duração pedida a cada espera do sistema.
+static const double SLEEP_STEP = 0.001;
+
+// Atraso suposto das esperas antes das primeiras medidas.
+static const double SLEEP_INITIAL_ESTIMATE = 0.002;
+
+// A média e a variância passam a valer por uma janela desse tamanho, para
+// acompanhar mudanças de carga do sistema.
+static const unsigned int SLEEP_MAX_SAMPLES = 1000;
+
+double Pacing_Now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - g_PacingEpoch).count();
+}
+
+void FrameLimiter_Init(FrameLimiter& limiter, double fps)
+{
+    limiter.interval = fps > 0.0 ? 1.0 / fps : 0.0;
+    limiter.next_frame = 0.0;
+    limiter.sleep_mean = 0.0;
+    limiter.sleep_m2 = 0.0;
+    limiter.sleep_samples = 0;
+}
+
+// Maior duração esperada de uma espera de SLEEP_STEP: média mais um desvio
+// padrão das medidas.
+static double SleepEstimate(const FrameLimiter& limiter)
+{
+    if (limiter.sleep_samples < 2)
+        return SLEEP_INITIAL_ESTIMATE;
+    return limiter.sleep_mean + std::sqrt(limiter.sleep_m2 / (limiter.sleep_samples - 1));
+}
+
+static void AddSleepSample(FrameLimiter& limiter, double duration)
+{
+    if (limiter.sleep_samples < SLEEP_MAX_SAMPLES)
+        ++limiter.sleep_samples;
+    double delta = duration - limiter.sleep_mean;
+    limiter.sleep_mean += delta / limiter.sleep_samples;
+    limiter.sleep_m2 += delta * (duration - limiter.sleep_mean);
+    if (limiter.sleep_samples == SLEEP_MAX_SAMPLES)
+        limiter.sleep_m2 *= (double)(SLEEP_MAX_SAMPLES - 1) / SLEEP_MAX_SAMPLES;
+}
+
+void FrameLimiter_Wait(FrameLimiter& limiter)
+{
+    if (limiter.interval <= 0.0)
+        return;
+
+    PROFILE_SCOPE("limite de quadros");
+    double now = Pacing_Now();
+    if (limiter.next_frame == 0.0 || now >= limiter.next_frame)
+    {
+        limiter.next_frame = now + limiter.interval;
+        return;
+    }
+
+    while (limiter.next_frame - now > SleepEstimate(limiter))
+    {
+        std::this_thread::sleep_for(std::chrono::duration<double>(SLEEP_STEP));
+        double after = Pacing_Now();
+        AddSleepSample(limiter, after - now);
+        now = after;
+    }
+    while (now < limiter.next_frame)
+    {
+        std::this_thread::yield();
+        now = Pacing_Now();
+    }
+
+    // Uma espera do sistema muito mais longa que o pedido pode passar de um
+    // intervalo inteiro; o próximo quadro também não é antecipado nesse caso.
+    limiter.next_frame += limiter.interval;
+    if (limiter.next_frame <= now)
+        limiter.next_frame = now + limiter.interval;
+}
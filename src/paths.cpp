@@ -0,0 +1,247 @@
+// Tabelas de trajetória parametrizadas por comprimento de arco.
+//
+// Uma curva paramétrica f(t) em geral não é percorrida com velocidade
+// constante quando t cresce linearmente (a Bézier do círculo, por exemplo,
+// acelera no meio de cada segmento). Para cada formato, amostramos a curva
+// densamente, acumulamos o comprimento de arco e invertemos essa função,
+// obtendo t(s). As posições f(t(s)) para s igualmente espaçados são guardadas
+// em uma tabela compartilhada por todos os alvos que usam o formato; avaliar
+// a posição de um alvo é então uma consulta O(1) com interpolação linear.
+#include <atomic>
+#include <cassert>
+#include <cmath>
+
+#include "paths.h"
+
+// Número de amostras usadas para medir o comprimento de arco de cada curva.
+static const int PATH_DENSE_SAMPLES = 4096;
+
+// Constante para aproximar um quarto de círculo com uma Bézier cúbica.
+static const float BEZIER_CIRCLE_K = 0.5522847f;
+
+// Duração de uma volta no círculo, em segundos. Os demais formatos usam a
+// mesma velocidade (em unidades de comprimento por segundo) do círculo.
+static const float CIRCLE_PERIOD = 4.0f;
+
+static const float PATH_PI = 3.14159265358979f;
+
+typedef void (*PathFunction)(const void* data, float t, float* p);
+
+static float CubicBezier(float t, float p0, float p1, float p2, float p3)
+{
+    float u = 1.0f - t;
+    return u*u*u*p0 + 3.0f*u*u*t*p1 + 3.0f*u*t*t*p2 + t*t*t*p3;
+}
+
+// Círculo de raio 1 no plano XZ: o primeiro segmento vai de (1,0) até (0,1) e
+// os outros três são rotações de 90 graus dele.
+static void CirclePath(const void*, float t, float* p)
+{
+    float u = 4.0f * t;
+    int segment = static_cast<int>(u);
+    if (segment > 3)
+        segment = 3;
+    float local_t = u - segment;
+
+    float x = CubicBezier(local_t, 1.0f, 1.0f, BEZIER_CIRCLE_K, 0.0f);
+    float z = CubicBezier(local_t, 0.0f, BEZIER_CIRCLE_K, 1.0f, 1.0f);
+    if (segment & 1)
+    {
+        float tmp = x;
+        x = -z;
+        z = tmp;
+    }
+    if (segment & 2)
+    {
+        x = -x;
+        z = -z;
+    }
+    p[0] = x;
+    p[1] = 0.0f;
+    p[2] = z;
+}
+
+static void FigureEightPath(const void*, float t, float* p)
+{
+    float a = 2.0f * PATH_PI * t;
+    p[0] = std::sin(a);
+    p[1] = 0.0f;
+    p[2] = std::sin(a) * std::cos(a);
+}
+
+static void StrafePath(const void*, float t, float* p)
+{
+    p[0] = (t < 0.5f) ? (-1.0f + 4.0f*t) : (3.0f - 4.0f*t);
+    p[1] = 0.0f;
+    p[2] = 0.0f;
+}
+
+// Spline de Catmull-Rom uniforme e fechada; "data" aponta para o vetor de
+// pontos de controle.
+static void CatmullRomPath(const void* data, float t, float* p)
+{
+    const std::vector<float>& points = *static_cast<const std::vector<float>*>(data);
+    int n = static_cast<int>(points.size() / 3);
+
+    float u = t * n;
+    int i = static_cast<int>(u);
+    if (i >= n)
+        i = n - 1;
+    float s = u - i;
+    float s2 = s*s;
+    float s3 = s2*s;
+
+    const float* p0 = &points[3 * ((i + n - 1) % n)];
+    const float* p1 = &points[3 * i];
+    const float* p2 = &points[3 * ((i + 1) % n)];
+    const float* p3 = &points[3 * ((i + 2) % n)];
+
+    for (int c = 0; c < 3; ++c)
+    {
+        p[c] = 0.5f * ((2.0f*p1[c]) +
+                       (-p0[c] + p2[c]) * s +
+                       (2.0f*p0[c] - 5.0f*p1[c] + 4.0f*p2[c] - p3[c]) * s2 +
+                       (-p0[c] + 3.0f*p1[c] - 3.0f*p2[c] + p3[c]) * s3);
+    }
+}
+
+// Constrói a tabela de um formato, reparametrizando f(t) por comprimento de
+// arco. O período é calculado para que a velocidade seja "speed".
+static PathTable BuildTable(PathFunction f, const void* data, float speed)
+{
+    // Comprimento de arco acumulado nas amostras densas.
+    std::vector<float> cumulative(PATH_DENSE_SAMPLES + 1, 0.0f);
+    float previous[3];
+    f(data, 0.0f, previous);
+    for (int j = 1; j <= PATH_DENSE_SAMPLES; ++j)
+    {
+        float p[3];
+        f(data, (j == PATH_DENSE_SAMPLES) ? 0.0f : (float)j / PATH_DENSE_SAMPLES, p);
+        float dx = p[0] - previous[0];
+        float dy = p[1] - previous[1];
+        float dz = p[2] - previous[2];
+        cumulative[j] = cumulative[j-1] + std::sqrt(dx*dx + dy*dy + dz*dz);
+        previous[0] = p[0];
+        previous[1] = p[1];
+        previous[2] = p[2];
+    }
+
+    PathTable table;
+    table.length = cumulative[PATH_DENSE_SAMPLES];
+    table.period = (speed > 0.0f) ? table.length / speed : CIRCLE_PERIOD;
+    table.bound = 0.0f;
+    table.positions.resize(3 * PATH_TABLE_SIZE);
+
+    // Inversão de s(t): as amostras alvo são crescentes, então basta avançar
+    // um índice pelas amostras densas.
+    int j = 0;
+    for (int k = 0; k < PATH_TABLE_SIZE; ++k)
+    {
+        float s = table.length * k / PATH_TABLE_SIZE;
+        while (j < PATH_DENSE_SAMPLES - 1 && cumulative[j+1] < s)
+            ++j;
+        float segment = cumulative[j+1] - cumulative[j];
+        float fraction = (segment > 0.0f) ? (s - cumulative[j]) / segment : 0.0f;
+        float t = (j + fraction) / PATH_DENSE_SAMPLES;
+
+        float* p = &table.positions[3*k];
+        f(data, t, p);
+        table.bound = std::fmax(table.bound, std::sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]));
+    }
+    return table;
+}
+
+// Biblioteca de formatos. Os pontos de controle das splines ficam guardados
+// junto das tabelas para que possam ser reconstruídas se necessário.
+struct PathLibrary
+{
+    std::vector<PathTable> tables;
+    std::vector<std::vector<float> > splines;
+    float speed;
+
+    // true depois da primeira consulta: daí em diante as tabelas não mudam
+    // (veja Paths_AddCatmullRom()).
+    std::atomic<bool> sealed;
+
+    PathLibrary() : sealed(false)
+    {
+        tables.reserve(PATH_MAX_SHAPES);
+        splines.reserve(PATH_MAX_SHAPES);
+
+        // O círculo define a velocidade de todos os formatos: uma volta em
+        // CIRCLE_PERIOD segundos, como antes da reparametrização.
+        PathTable circle = BuildTable(CirclePath, NULL, 0.0f);
+        speed = circle.length / CIRCLE_PERIOD;
+        tables.push_back(circle);
+
+        tables.push_back(BuildTable(FigureEightPath, NULL, speed));
+        tables.push_back(BuildTable(StrafePath, NULL, speed));
+
+        // Um quadrado de cantos arredondados que sobe e desce.
+        const float wave[] = {
+             1.0f,  0.4f,  0.0f,    0.7f, 0.0f,  0.7f,
+             0.0f, -0.4f,  1.0f,   -0.7f, 0.0f,  0.7f,
+            -1.0f,  0.4f,  0.0f,   -0.7f, 0.0f, -0.7f,
+             0.0f, -0.4f, -1.0f,    0.7f, 0.0f, -0.7f,
+        };
+        AddCatmullRom(std::vector<float>(wave, wave + sizeof(wave)/sizeof(wave[0])));
+    }
+
+    int AddCatmullRom(const std::vector<float>& points)
+    {
+        if ((int)tables.size() >= PATH_MAX_SHAPES || points.size() < 9)
+            return -1;
+        splines.push_back(points);
+        tables.push_back(BuildTable(CatmullRomPath, &splines.back(), speed));
+        return (int)tables.size() - 1;
+    }
+};
+
+static PathLibrary& GetLibrary()
+{
+    static PathLibrary library;
+    return library;
+}
+
+static PathLibrary& SealedLibrary()
+{
+    PathLibrary& library = GetLibrary();
+    if (!library.sealed.load(std::memory_order_relaxed))
+        library.sealed.store(true, std::memory_order_relaxed);
+    return library;
+}
+
+int Paths_Count()
+{
+    return (int)SealedLibrary().tables.size();
+}
+
+const PathTable& Paths_Get(int shape)
+{
+    return SealedLibrary().tables[shape];
+}
+
+int Paths_AddCatmullRom(const std::vector<float>& control_points)
+{
+    PathLibrary& library = GetLibrary();
+    assert(!library.sealed.load() && "Paths_AddCatmullRom() depois da primeira consulta às tabelas");
+    if (library.sealed.load())
+        return -1;
+    return library.AddCatmullRom(control_points);
+}
+
+void Paths_Sample(const PathTable& path, float s, float* x, float* y, float* z)
+{
+    float u = s * PATH_TABLE_SIZE;
+    int i0 = static_cast<int>(u);
+    if (i0 >= PATH_TABLE_SIZE)
+        i0 = PATH_TABLE_SIZE - 1;
+    int i1 = (i0 + 1) % PATH_TABLE_SIZE;
+    float f = u - i0;
+
+    const float* a = &path.positions[3*i0];
+    const float* b = &path.positions[3*i1];
+    *x = a[0] + (b[0] - a[0]) * f;
+    *y = a[1] + (b[1] - a[1]) * f;
+    *z = a[2] + (b[2] - a[2]) * f;
+}
@@ -0,0 +1,177 @@
+// Perfil da CPU com marcadores de escopo. Veja profiler.h.
+#include <cstdio>
+
+#include "profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+struct ProfileEvent
+{
+    const char* name;
+    uint64_t begin_ns;
+    uint64_t end_ns;
+};
+
+// Anel de uma thread. Só a thread dona escreve; "written" é publicado com
+// release depois de cada escrita, então a exportação vê os eventos
+// completos até ele.
+struct ProfileRing
+{
+    std::atomic<uint64_t> written;
+    ProfileEvent events[PROFILER_RING_EVENTS];
+    const char* thread_name;
+    int thread_id;
+};
+
+static const std::chrono::steady_clock::time_point g_ProfilerEpoch = std::chrono::steady_clock::now();
+
+// Todos os anéis já criados; a trava só é usada ao registrar uma thread e
+// ao exportar. Os anéis nunca são liberados, para que os eventos de threads
+// já encerradas também sejam exportados.
+static std::mutex g_ProfilerRingsMutex;
+static std::vector<ProfileRing*> g_ProfilerRings;
+
+static thread_local ProfileRing* t_ProfilerRing = NULL;
+
+static ProfileRing* ThreadRing()
+{
+    if (t_ProfilerRing == NULL)
+    {
+        ProfileRing* ring = new ProfileRing;
+        ring->written.store(0, std::memory_order_relaxed);
+        ring->thread_name = NULL;
+
+        std::lock_guard<std::mutex> lock(g_ProfilerRingsMutex);
+        ring->thread_id = (int)g_ProfilerRings.size() + 1;
+        g_ProfilerRings.push_back(ring);
+        t_ProfilerRing = ring;
+    }
+    return t_ProfilerRing;
+}
+
+uint64_t Profiler_Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_ProfilerEpoch).count();
+}
+
+void Profiler_Record(const char* name, uint64_t begin_ns, uint64_t end_ns)
+{
+    ProfileRing* ring = ThreadRing();
+    uint64_t index = ring->written.load(std::memory_order_relaxed);
+    ProfileEvent& event = ring->events[index & (PROFILER_RING_EVENTS - 1)];
+    event.name = name;
+    event.begin_ns = begin_ns;
+    event.end_ns = end_ns;
+    ring->written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler_SetThreadName(const char* name)
+{
+    ThreadRing()->thread_name = name;
+}
+
+// Escreve uma string JSON; os nomes são literais do programa, então só as
+// aspas e as barras precisam de escape.
+static void WriteJsonString(FILE* file, const char* text)
+{
+    fputc('"', file);
+    for (const char* c = text; *c != '\0'; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool Profiler_ExportChromeTrace(const char* path)
+{
+    std::vector<ProfileRing*> rings;
+    {
+        std::lock_guard<std::mutex> lock(g_ProfilerRingsMutex);
+        rings = g_ProfilerRings;
+    }
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERRO: não foi possível criar \"%s\".\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    size_t exported = 0;
+    std::vector<ProfileEvent> events;
+    for (size_t r = 0; r < rings.size(); ++r)
+    {
+        ProfileRing* ring = rings[r];
+
+        // Copia os eventos mais recentes. Os que a thread sobrescreveu
+        // durante a cópia são descartados.
+        uint64_t end = ring->written.load(std::memory_order_acquire);
+        uint64_t begin = end > PROFILER_RING_EVENTS ? end - PROFILER_RING_EVENTS : 0;
+        events.clear();
+        for (uint64_t i = begin; i < end; ++i)
+            events.push_back(ring->events[i & (PROFILER_RING_EVENTS - 1)]);
+        uint64_t after = ring->written.load(std::memory_order_acquire);
+        uint64_t first_valid = after > PROFILER_RING_EVENTS ? after - PROFILER_RING_EVENTS : 0;
+        size_t overwritten = first_valid > begin ? (size_t)std::min<uint64_t>(first_valid - begin, events.size()) : 0;
+
+        if (ring->thread_name != NULL)
+        {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                    first ? "" : ",\n", ring->thread_id);
+            WriteJsonString(file, ring->thread_name);
+            fprintf(file, "}}");
+            first = false;
+        }
+        for (size_t i = overwritten; i < events.size(); ++i)
+        {
+            const ProfileEvent& event = events[i];
+            fprintf(file, "%s{\"name\":", first ? "" : ",\n");
+            WriteJsonString(file, event.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", ring->thread_id,
+                    event.begin_ns / 1000.0, (event.end_ns - event.begin_ns) / 1000.0);
+            first = false;
+            ++exported;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = fclose(file) == 0;
+    if (ok)
+        printf("Perfil da CPU: %zu marcadores de %zu threads gravados em \"%s\"\n", exported, rings.size(), path);
+    else
+        fprintf(stderr, "ERRO: falha ao gravar \"%s\".\n", path);
+    return ok;
+}
+
+#else
+
+uint64_t Profiler_Now()
+{
+    return 0;
+}
+
+void Profiler_Record(const char*, uint64_t, uint64_t)
+{
+}
+
+void Profiler_SetThreadName(const char*)
+{
+}
+
+bool Profiler_ExportChromeTrace(const char* path)
+{
+    fprintf(stderr, "ERRO: perfil da CPU desativado nesta build; compile com ENABLE_PROFILER para gravar \"%s\".\n", path);
+    return false;
+}
+
+#endif // PROFILER_ENABLED
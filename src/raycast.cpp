@@ -0,0 +1,333 @@
+// Interseção de pacotes de raios contra conjuntos de esferas (SoA), com
+// kernels escalar, SSE e AVX2. O kernel é escolhido em tempo de execução de
+// acordo com as instruções suportadas pela CPU.
+#include <cmath>
+#include <limits>
+
+#include "raycast.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define RAYCAST_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define RAYCAST_TARGET_AVX2
+#else
+#define RAYCAST_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+static const float RAYCAST_NO_HIT = std::numeric_limits<float>::infinity();
+
+// Distância ao longo do raio (o + t*d, com d normalizado) até a primeira
+// interseção com a esfera (c, r). Retorna infinito caso não haja interseção
+// à frente da origem do raio. Se a origem está dentro da esfera, retorna a
+// distância até a saída.
+static inline float RaySphereDistance(float ox, float oy, float oz,
+                                      float dx, float dy, float dz,
+                                      float cx, float cy, float cz, float r)
+{
+    float ocx = cx - ox;
+    float ocy = cy - oy;
+    float ocz = cz - oz;
+
+    float tca = ocx*dx + ocy*dy + ocz*dz;
+    float d2  = ocx*ocx + ocy*ocy + ocz*ocz - tca*tca;
+    float h   = r*r - d2;
+    if (h < 0.0f)
+        return RAYCAST_NO_HIT;
+
+    float thc = std::sqrt(h);
+    float t0 = tca - thc;
+    float t1 = tca + thc;
+    float t = (t0 >= 0.0f) ? t0 : t1;
+    if (t < 0.0f)
+        return RAYCAST_NO_HIT;
+    return t;
+}
+
+static void NearestHits_Scalar(const RayPacket& rays, const SphereSet& spheres, size_t begin, size_t end,
+                               RayHit* hits)
+{
+    const float* cx = spheres.center_x.data();
+    const float* cy = spheres.center_y.data();
+    const float* cz = spheres.center_z.data();
+    const float* cr = spheres.radius.data();
+
+    for (size_t ray = 0; ray < rays.Size(); ++ray)
+    {
+        const float ox = rays.origin_x[ray], oy = rays.origin_y[ray], oz = rays.origin_z[ray];
+        const float dx = rays.dir_x[ray],    dy = rays.dir_y[ray],    dz = rays.dir_z[ray];
+
+        int   best_index = -1;
+        float best_t = RAYCAST_NO_HIT;
+        for (size_t i = begin; i < end; ++i)
+        {
+            float t = RaySphereDistance(ox, oy, oz, dx, dy, dz, cx[i], cy[i], cz[i], cr[i]);
+            if (t < best_t)
+            {
+                best_t = t;
+                best_index = static_cast<int>(i);
+            }
+        }
+        hits[ray].index = best_index;
+        hits[ray].distance = best_t;
+    }
+}
+
+#ifdef RAYCAST_X86
+
+// Redução final dos melhores resultados de cada "lane" SIMD e das esferas
+// que sobraram no fim do vetor (quando o número de esferas não é múltiplo
+// da largura do vetor).
+static inline void ReduceLanes(const float* lane_t, const int* lane_index, int lanes,
+                               const RayPacket& rays, size_t ray, const SphereSet& spheres,
+                               size_t tail_begin, size_t end, RayHit* hit)
+{
+    int   best_index = -1;
+    float best_t = RAYCAST_NO_HIT;
+    for (int lane = 0; lane < lanes; ++lane)
+    {
+        if (lane_index[lane] < 0)
+            continue;
+        if (lane_t[lane] < best_t || (lane_t[lane] == best_t && lane_index[lane] < best_index))
+        {
+            best_t = lane_t[lane];
+            best_index = lane_index[lane];
+        }
+    }
+
+    for (size_t i = tail_begin; i < end; ++i)
+    {
+        float t = RaySphereDistance(rays.origin_x[ray], rays.origin_y[ray], rays.origin_z[ray],
+                                    rays.dir_x[ray], rays.dir_y[ray], rays.dir_z[ray],
+                                    spheres.center_x[i], spheres.center_y[i], spheres.center_z[i],
+                                    spheres.radius[i]);
+        if (t < best_t)
+        {
+            best_t = t;
+            best_index = static_cast<int>(i);
+        }
+    }
+
+    hit->index = best_index;
+    hit->distance = best_t;
+}
+
+// Kernel SSE2: 4 esferas por iteração. SSE2 faz parte da arquitetura x86-64,
+// então este kernel está sempre disponível nesta plataforma.
+static void NearestHits_SSE(const RayPacket& rays, const SphereSet& spheres, size_t begin, size_t end,
+                            RayHit* hits)
+{
+    const size_t num_vector = begin + ((end - begin) & ~static_cast<size_t>(3));
+    const int first = static_cast<int>(begin);
+    const float* cx = spheres.center_x.data();
+    const float* cy = spheres.center_y.data();
+    const float* cz = spheres.center_z.data();
+    const float* cr = spheres.radius.data();
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 no_hit = _mm_set1_ps(RAYCAST_NO_HIT);
+    const __m128i four = _mm_set1_epi32(4);
+
+    for (size_t ray = 0; ray < rays.Size(); ++ray)
+    {
+        const __m128 ox = _mm_set1_ps(rays.origin_x[ray]);
+        const __m128 oy = _mm_set1_ps(rays.origin_y[ray]);
+        const __m128 oz = _mm_set1_ps(rays.origin_z[ray]);
+        const __m128 dx = _mm_set1_ps(rays.dir_x[ray]);
+        const __m128 dy = _mm_set1_ps(rays.dir_y[ray]);
+        const __m128 dz = _mm_set1_ps(rays.dir_z[ray]);
+
+        __m128  best_t = no_hit;
+        __m128i best_index = _mm_set1_epi32(-1);
+        __m128i index = _mm_setr_epi32(first, first + 1, first + 2, first + 3);
+
+        for (size_t i = begin; i < num_vector; i += 4)
+        {
+            __m128 ocx = _mm_sub_ps(_mm_loadu_ps(cx + i), ox);
+            __m128 ocy = _mm_sub_ps(_mm_loadu_ps(cy + i), oy);
+            __m128 ocz = _mm_sub_ps(_mm_loadu_ps(cz + i), oz);
+            __m128 r   = _mm_loadu_ps(cr + i);
+
+            __m128 tca = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, dx), _mm_mul_ps(ocy, dy)), _mm_mul_ps(ocz, dz));
+            __m128 oc2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocx, ocx), _mm_mul_ps(ocy, ocy)), _mm_mul_ps(ocz, ocz));
+            __m128 d2  = _mm_sub_ps(oc2, _mm_mul_ps(tca, tca));
+            __m128 h   = _mm_sub_ps(_mm_mul_ps(r, r), d2);
+            __m128 valid = _mm_cmpge_ps(h, zero);
+
+            // Na maioria das iterações o raio não passa perto de nenhuma das
+            // esferas do grupo: evitamos a raiz quadrada, a operação mais cara.
+            if (_mm_movemask_ps(valid) == 0)
+            {
+                index = _mm_add_epi32(index, four);
+                continue;
+            }
+
+            __m128 thc = _mm_sqrt_ps(_mm_max_ps(h, zero));
+            __m128 t0 = _mm_sub_ps(tca, thc);
+            __m128 t1 = _mm_add_ps(tca, thc);
+            __m128 use_t0 = _mm_cmpge_ps(t0, zero);
+            __m128 t = _mm_or_ps(_mm_and_ps(use_t0, t0), _mm_andnot_ps(use_t0, t1));
+            valid = _mm_and_ps(valid, _mm_cmpge_ps(t, zero));
+
+            __m128 closer = _mm_and_ps(valid, _mm_cmplt_ps(t, best_t));
+            best_t = _mm_or_ps(_mm_and_ps(closer, t), _mm_andnot_ps(closer, best_t));
+            __m128i closer_i = _mm_castps_si128(closer);
+            best_index = _mm_or_si128(_mm_and_si128(closer_i, index), _mm_andnot_si128(closer_i, best_index));
+
+            index = _mm_add_epi32(index, four);
+        }
+
+        float lane_t[4];
+        int   lane_index[4];
+        _mm_storeu_ps(lane_t, best_t);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lane_index), best_index);
+        ReduceLanes(lane_t, lane_index, 4, rays, ray, spheres, num_vector, end, &hits[ray]);
+    }
+}
+
+// Kernel AVX2: 8 esferas por iteração.
+RAYCAST_TARGET_AVX2
+static void NearestHits_AVX2(const RayPacket& rays, const SphereSet& spheres, size_t begin, size_t end,
+                             RayHit* hits)
+{
+    const size_t num_vector = begin + ((end - begin) & ~static_cast<size_t>(7));
+    const int first = static_cast<int>(begin);
+    const float* cx = spheres.center_x.data();
+    const float* cy = spheres.center_y.data();
+    const float* cz = spheres.center_z.data();
+    const float* cr = spheres.radius.data();
+
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 no_hit = _mm256_set1_ps(RAYCAST_NO_HIT);
+    const __m256i eight = _mm256_set1_epi32(8);
+
+    for (size_t ray = 0; ray < rays.Size(); ++ray)
+    {
+        const __m256 ox = _mm256_set1_ps(rays.origin_x[ray]);
+        const __m256 oy = _mm256_set1_ps(rays.origin_y[ray]);
+        const __m256 oz = _mm256_set1_ps(rays.origin_z[ray]);
+        const __m256 dx = _mm256_set1_ps(rays.dir_x[ray]);
+        const __m256 dy = _mm256_set1_ps(rays.dir_y[ray]);
+        const __m256 dz = _mm256_set1_ps(rays.dir_z[ray]);
+
+        __m256  best_t = no_hit;
+        __m256i best_index = _mm256_set1_epi32(-1);
+        __m256i index = _mm256_setr_epi32(first, first + 1, first + 2, first + 3,
+                                          first + 4, first + 5, first + 6, first + 7);
+
+        for (size_t i = begin; i < num_vector; i += 8)
+        {
+            __m256 ocx = _mm256_sub_ps(_mm256_loadu_ps(cx + i), ox);
+            __m256 ocy = _mm256_sub_ps(_mm256_loadu_ps(cy + i), oy);
+            __m256 ocz = _mm256_sub_ps(_mm256_loadu_ps(cz + i), oz);
+            __m256 r   = _mm256_loadu_ps(cr + i);
+
+            __m256 tca = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, dx), _mm256_mul_ps(ocy, dy)), _mm256_mul_ps(ocz, dz));
+            __m256 oc2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocx, ocx), _mm256_mul_ps(ocy, ocy)), _mm256_mul_ps(ocz, ocz));
+            __m256 d2  = _mm256_sub_ps(oc2, _mm256_mul_ps(tca, tca));
+            __m256 h   = _mm256_sub_ps(_mm256_mul_ps(r, r), d2);
+            __m256 valid = _mm256_cmp_ps(h, zero, _CMP_GE_OQ);
+
+            if (_mm256_movemask_ps(valid) == 0)
+            {
+                index = _mm256_add_epi32(index, eight);
+                continue;
+            }
+
+            __m256 thc = _mm256_sqrt_ps(_mm256_max_ps(h, zero));
+            __m256 t0 = _mm256_sub_ps(tca, thc);
+            __m256 t1 = _mm256_add_ps(tca, thc);
+            __m256 t = _mm256_blendv_ps(t1, t0, _mm256_cmp_ps(t0, zero, _CMP_GE_OQ));
+            valid = _mm256_and_ps(valid, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+
+            __m256 closer = _mm256_and_ps(valid, _mm256_cmp_ps(t, best_t, _CMP_LT_OQ));
+            best_t = _mm256_blendv_ps(best_t, t, closer);
+            best_index = _mm256_blendv_epi8(best_index, index, _mm256_castps_si256(closer));
+
+            index = _mm256_add_epi32(index, eight);
+        }
+
+        float lane_t[8];
+        int   lane_index[8];
+        _mm256_storeu_ps(lane_t, best_t);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lane_index), best_index);
+        ReduceLanes(lane_t, lane_index, 8, rays, ray, spheres, num_vector, end, &hits[ray]);
+    }
+}
+
+static bool CpuSupportsAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx     = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // RAYCAST_X86
+
+RayCastKernel RayCast_BestSupportedKernel()
+{
+#ifdef RAYCAST_X86
+    static const RayCastKernel best = CpuSupportsAVX2() ? RAYCAST_KERNEL_AVX2 : RAYCAST_KERNEL_SSE;
+    return best;
+#else
+    return RAYCAST_KERNEL_SCALAR;
+#endif
+}
+
+static RayCastKernel g_RayCastKernel = RayCast_BestSupportedKernel();
+
+RayCastKernel RayCast_ActiveKernel()
+{
+    return g_RayCastKernel;
+}
+
+bool RayCast_SetKernel(RayCastKernel kernel)
+{
+    if (kernel > RayCast_BestSupportedKernel())
+        return false;
+    g_RayCastKernel = kernel;
+    return true;
+}
+
+const char* RayCast_KernelName(RayCastKernel kernel)
+{
+    switch (kernel)
+    {
+        case RAYCAST_KERNEL_SSE:  return "SSE";
+        case RAYCAST_KERNEL_AVX2: return "AVX2";
+        default:                  return "escalar";
+    }
+}
+
+void RayCast_NearestHits(const RayPacket& rays, const SphereSet& spheres, RayHit* hits)
+{
+    RayCast_NearestHitsRange(rays, spheres, 0, spheres.Size(), hits);
+}
+
+void RayCast_NearestHitsRange(const RayPacket& rays, const SphereSet& spheres, size_t begin, size_t end,
+                              RayHit* hits)
+{
+    switch (g_RayCastKernel)
+    {
+#ifdef RAYCAST_X86
+        case RAYCAST_KERNEL_AVX2: NearestHits_AVX2(rays, spheres, begin, end, hits); break;
+        case RAYCAST_KERNEL_SSE:  NearestHits_SSE(rays, spheres, begin, end, hits); break;
+#endif
+        default:                  NearestHits_Scalar(rays, spheres, begin, end, hits); break;
+    }
+}
@@ -0,0 +1,165 @@
+// Arquivo de sessão gravada. Veja replay.h.
+#include <cstdio>
+#include <cstring>
+
+#include "replay.h"
+
+// Formato: cabeçalho (identificador, versão, semente, passo, número de
+// passos, hash do estado final e número de eventos) seguido dos eventos.
+// Cada campo é gravado separadamente, em little-endian, de forma que o
+// arquivo não depende do compilador (alinhamento, preenchimento) nem da
+// máquina.
+static const char INPUT_LOG_MAGIC[4] = { 'T', 'F', 'R', 'L' };
+static const uint32_t INPUT_LOG_VERSION = 2;
+static const size_t INPUT_LOG_HEADER_BYTES = 4 + 4 + 8 + 8 + 4 + 8 + 8;
+static const size_t INPUT_EVENT_BYTES = 8 + 8 + 4 + 4 + 4 + 4 + 1 + 1 + 2;
+
+static void PutUint(std::vector<unsigned char>* out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        out->push_back(static_cast<unsigned char>(value >> (8 * i)));
+}
+
+static void PutDouble(std::vector<unsigned char>* out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    PutUint(out, bits, 8);
+}
+
+static void PutFloat(std::vector<unsigned char>* out, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    PutUint(out, bits, 4);
+}
+
+static uint64_t GetUint(const unsigned char** in, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i)
+        value |= static_cast<uint64_t>((*in)[i]) << (8 * i);
+    *in += bytes;
+    return value;
+}
+
+static double GetDouble(const unsigned char** in)
+{
+    uint64_t bits = GetUint(in, 8);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static float GetFloat(const unsigned char** in)
+{
+    uint32_t bits = static_cast<uint32_t>(GetUint(in, 4));
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+bool InputLog_Save(const InputLog& log, const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERRO: não foi possível criar \"%s\".\n", path);
+        return false;
+    }
+
+    std::vector<unsigned char> bytes;
+    bytes.reserve(INPUT_LOG_HEADER_BYTES + log.events.size() * INPUT_EVENT_BYTES);
+    bytes.insert(bytes.end(), INPUT_LOG_MAGIC, INPUT_LOG_MAGIC + sizeof(INPUT_LOG_MAGIC));
+    PutUint(&bytes, INPUT_LOG_VERSION, 4);
+    PutUint(&bytes, log.seed, 8);
+    PutDouble(&bytes, log.step);
+    PutUint(&bytes, log.total_steps, 4);
+    PutUint(&bytes, log.final_state_hash, 8);
+    PutUint(&bytes, log.events.size(), 8);
+    for (size_t i = 0; i < log.events.size(); ++i)
+    {
+        const InputEvent& event = log.events[i];
+        PutDouble(&bytes, event.x);
+        PutDouble(&bytes, event.y);
+        PutUint(&bytes, event.step, 4);
+        PutFloat(&bytes, event.time);
+        PutUint(&bytes, static_cast<uint32_t>(event.code), 4);
+        PutUint(&bytes, static_cast<uint32_t>(event.scancode), 4);
+        PutUint(&bytes, event.type, 1);
+        PutUint(&bytes, event.action, 1);
+        PutUint(&bytes, event.mods, 2);
+    }
+
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok)
+        fprintf(stderr, "ERRO: falha ao gravar \"%s\".\n", path);
+    return ok;
+}
+
+// Lê o arquivo inteiro. O tamanho é conhecido antes de decodificar, então
+// um número de eventos corrompido não causa uma alocação enorme.
+static bool ReadFile(FILE* file, std::vector<unsigned char>* bytes)
+{
+    if (fseek(file, 0, SEEK_END) != 0)
+        return false;
+    long size = ftell(file);
+    if (size < 0 || fseek(file, 0, SEEK_SET) != 0)
+        return false;
+    bytes->resize(static_cast<size_t>(size));
+    return size == 0 || fread(bytes->data(), 1, bytes->size(), file) == bytes->size();
+}
+
+bool InputLog_Load(InputLog* log, const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERRO: não foi possível abrir \"%s\".\n", path);
+        return false;
+    }
+
+    std::vector<unsigned char> bytes;
+    bool ok = ReadFile(file, &bytes)
+           && bytes.size() >= INPUT_LOG_HEADER_BYTES
+           && memcmp(bytes.data(), INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC)) == 0;
+    fclose(file);
+    if (ok)
+    {
+        const unsigned char* in = bytes.data() + sizeof(INPUT_LOG_MAGIC);
+        uint32_t version = static_cast<uint32_t>(GetUint(&in, 4));
+        log->seed = GetUint(&in, 8);
+        log->step = GetDouble(&in);
+        log->total_steps = static_cast<uint32_t>(GetUint(&in, 4));
+        log->final_state_hash = GetUint(&in, 8);
+        uint64_t count = GetUint(&in, 8);
+
+        // O número de eventos precisa bater com o resto do arquivo.
+        size_t remaining = bytes.size() - INPUT_LOG_HEADER_BYTES;
+        ok = version == INPUT_LOG_VERSION && count == remaining / INPUT_EVENT_BYTES
+          && remaining % INPUT_EVENT_BYTES == 0;
+        if (ok)
+        {
+            log->events.resize(static_cast<size_t>(count));
+            for (size_t i = 0; i < log->events.size(); ++i)
+            {
+                InputEvent& event = log->events[i];
+                event.x = GetDouble(&in);
+                event.y = GetDouble(&in);
+                event.step = static_cast<uint32_t>(GetUint(&in, 4));
+                event.time = GetFloat(&in);
+                event.code = static_cast<int32_t>(GetUint(&in, 4));
+                event.scancode = static_cast<int32_t>(GetUint(&in, 4));
+                event.type = static_cast<uint8_t>(GetUint(&in, 1));
+                event.action = static_cast<uint8_t>(GetUint(&in, 1));
+                event.mods = static_cast<uint16_t>(GetUint(&in, 2));
+            }
+        }
+    }
+
+    if (!ok)
+        fprintf(stderr, "ERRO: \"%s\" não é uma sessão gravada válida.\n", path);
+    return ok;
+}
@@ -0,0 +1,89 @@
+// Gerador de números pseudo-aleatórios da sessão. Substitui srand()/rand(),
+// que eram re-semeados com time(0) a cada alvo criado (alvos criados no mesmo
+// segundo recebiam a mesma posição) e não permitiam reproduzir uma partida.
+#include <chrono>
+#include <random>
+
+#include "rng.h"
+
+static const uint64_t PCG_MULTIPLIER = 6364136223846793005ULL;
+
+void Rng::Seed(uint64_t seed, uint64_t sequence)
+{
+    // Inicialização de referência do PCG32: o incremento precisa ser ímpar.
+    state = 0;
+    increment = (sequence << 1) | 1;
+    NextU32();
+    state += seed;
+    NextU32();
+}
+
+uint32_t Rng::NextU32()
+{
+    uint64_t old = state;
+    state = old * PCG_MULTIPLIER + increment;
+    uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+    uint32_t rot = static_cast<uint32_t>(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+uint32_t Rng::NextBelow(uint32_t n)
+{
+    // Método de Lemire: multiplicação de 64 bits, rejeitando os poucos
+    // valores que causariam viés.
+    uint64_t m = static_cast<uint64_t>(NextU32()) * n;
+    uint32_t low = static_cast<uint32_t>(m);
+    if (low < n)
+    {
+        uint32_t threshold = (0u - n) % n;
+        while (low < threshold)
+        {
+            m = static_cast<uint64_t>(NextU32()) * n;
+            low = static_cast<uint32_t>(m);
+        }
+    }
+    return static_cast<uint32_t>(m >> 32);
+}
+
+void Rng::FillFloats(float* out, size_t count)
+{
+    // Estado em variável local, para que o compilador o mantenha em um
+    // registrador durante o laço.
+    uint64_t s = state;
+    const uint64_t inc = increment;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t old = s;
+        s = old * PCG_MULTIPLIER + inc;
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        uint32_t rot = static_cast<uint32_t>(old >> 59);
+        uint32_t r = (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+        out[i] = (r >> 8) * (1.0f / 16777216.0f);
+    }
+    state = s;
+}
+
+static uint64_t g_SessionSeed = 0;
+
+void Rng_SeedStreams(Rng* streams, uint64_t seed)
+{
+    for (int i = 0; i < RNG_NUM_STREAMS; ++i)
+        streams[i].Seed(seed, static_cast<uint64_t>(i));
+}
+
+void Rng_SetSessionSeed(uint64_t seed)
+{
+    g_SessionSeed = seed;
+}
+
+uint64_t Rng_SessionSeed()
+{
+    return g_SessionSeed;
+}
+
+uint64_t Rng_RandomSeed()
+{
+    std::random_device device;
+    uint64_t seed = (static_cast<uint64_t>(device()) << 32) | device();
+    return seed ^ static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count());
+}
@@ -0,0 +1,44 @@
+// Agendador de eventos de jogo: criação de alvos, fim do tempo de vida dos
+// alvos, fim da rodada e intervalo entre tiros.
+#include <algorithm>
+#include <limits>
+
+#include "scheduler.h"
+
+// std::push_heap/pop_heap montam um max-heap; invertendo a comparação, o
+// topo é o evento mais cedo e, entre eventos no mesmo instante, o agendado
+// primeiro.
+static bool Later(const GameEvent& a, const GameEvent& b)
+{
+    if (a.time != b.time)
+        return a.time > b.time;
+    return a.sequence > b.sequence;
+}
+
+void EventScheduler::Schedule(double time, int type, int payload)
+{
+    GameEvent event;
+    event.time = time;
+    event.type = type;
+    event.payload = payload;
+    event.sequence = next_sequence_++;
+    heap_.push_back(event);
+    std::push_heap(heap_.begin(), heap_.end(), Later);
+}
+
+bool EventScheduler::PopDue(double now, GameEvent* event)
+{
+    if (heap_.empty() || heap_.front().time > now)
+        return false;
+    std::pop_heap(heap_.begin(), heap_.end(), Later);
+    *event = heap_.back();
+    heap_.pop_back();
+    return true;
+}
+
+double EventScheduler::NextTime() const
+{
+    if (heap_.empty())
+        return std::numeric_limits<double>::infinity();
+    return heap_.front().time;
+}
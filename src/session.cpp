@@ -0,0 +1,115 @@
+// Várias sessões de jogo no mesmo processo. Veja session.h.
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include "session.h"
+#include "jobs.h"
+#include "stats.h"
+
+typedef std::chrono::steady_clock SessionClock;
+
+static double ElapsedMs(SessionClock::time_point from, SessionClock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+void GameSession_Init(GameSession& session, uint64_t seed, double step)
+{
+    Simulation_Init(session.sim, 0.0, seed);
+    session.sim.print_hits = false;
+    session.seed = seed;
+    session.step = step;
+    session.steps = 0;
+    session.step_ms.clear();
+}
+
+void GameSession_Step(GameSession& session, long count)
+{
+    session.step_ms.reserve(session.step_ms.size() + count);
+    for (long i = 0; i < count; ++i)
+    {
+        double now = ++session.steps * session.step;
+        SessionClock::time_point t0 = SessionClock::now();
+        Simulation_StepHeadless(session.sim, now, session.step);
+        session.step_ms.push_back((float)ElapsedMs(t0, SessionClock::now()));
+    }
+}
+
+// Tarefa de uma sessão: cria a simulação e executa todos os passos.
+struct SessionJob
+{
+    GameSession* session;
+    uint64_t seed;
+    double step;
+    long steps;
+    double wall_ms; // Duração da tarefa
+};
+
+static void RunSession(void* data)
+{
+    SessionJob& job = *static_cast<SessionJob*>(data);
+    SessionClock::time_point start = SessionClock::now();
+    GameSession_Init(*job.session, job.seed, job.step);
+    GameSession_Step(*job.session, job.steps);
+    job.wall_ms = ElapsedMs(start, SessionClock::now());
+}
+
+void SessionHost_Run(const SessionHostOptions& options)
+{
+    long steps = static_cast<long>(std::ceil(options.seconds / options.step));
+    std::vector<GameSession> sessions(options.sessions);
+    std::vector<SessionJob> jobs(options.sessions);
+
+    // Uma tarefa por sessão: as trabalhadoras roubam as sessões ainda não
+    // iniciadas, e cada sessão avança inteira na thread que a pegou.
+    JobCounter counter;
+    SessionClock::time_point start = SessionClock::now();
+    for (int i = 0; i < options.sessions; ++i)
+    {
+        SessionJob& job = jobs[i];
+        job.session = &sessions[i];
+        job.seed = options.seed + static_cast<uint64_t>(i);
+        job.step = options.step;
+        job.steps = steps;
+        job.wall_ms = 0.0;
+        Jobs_Submit("sessão", RunSession, &job, &counter);
+    }
+    Jobs_Wait(&counter);
+    double wall = ElapsedMs(start, SessionClock::now()) / 1000.0;
+
+    // O resumo combina os estados finais na ordem das sessões, então é o
+    // mesmo com qualquer número de threads.
+    std::vector<double> step_us;
+    std::vector<double> session_ms(options.sessions);
+    step_us.reserve((size_t)options.sessions * steps);
+    uint64_t hash = 14695981039346656037ULL;
+    unsigned long kills = 0;
+    unsigned long points = 0;
+    for (int i = 0; i < options.sessions; ++i)
+    {
+        const GameSession& session = sessions[i];
+        for (size_t s = 0; s < session.step_ms.size(); ++s)
+            step_us.push_back(session.step_ms[s] * 1000.0);
+        session_ms[i] = jobs[i].wall_ms;
+        uint64_t state = Simulation_StateHash(session.sim);
+        for (int b = 0; b < 8; ++b)
+        {
+            hash ^= (state >> (8 * b)) & 0xff;
+            hash *= 1099511628211ULL;
+        }
+        kills += session.sim.kills;
+        points += session.sim.points;
+    }
+
+    printf("Sessões: %d de %ld passos de %.4f s (%.1f s simulados), sementes %llu a %llu\n", options.sessions, steps,
+           options.step, steps * options.step, (unsigned long long)options.seed,
+           (unsigned long long)(options.seed + options.sessions - 1));
+    printf("Threads: %d trabalhadoras e a principal (veja jobs.h)\n", Jobs_WorkerCount());
+    printf("Tempo total: %.3f s; sessões por segundo: %.1f; passos por segundo: %.0f\n", wall,
+           options.sessions / wall, options.sessions * steps / wall);
+    Stats_Print("Passo", "µs", step_us);
+    Stats_Print("Sessão", "ms", session_ms);
+    printf("Alvos destruídos: %lu, pontos: %lu, resumo do estado: %016llx\n", kills, points,
+           (unsigned long long)hash);
+}
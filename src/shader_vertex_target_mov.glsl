@@ -0,0 +1,79 @@
+#version 330 core
+
+// Vertex Shader dos alvos em movimento (tipo 1). Todos os alvos em movimento
+// são desenhados com uma única chamada instanciada: cada instância recebe os
+// parâmetros da sua trajetória, enviados para a GPU uma única vez quando o
+// alvo é criado, e a posição do alvo é calculada aqui a partir do uniform
+// "time". Veja a MotionPool em "motion.h" e DrawMovingTargets() em "main.cpp".
+
+// Atributos de vértice do modelo da esfera (iguais aos de "shader_vertex.glsl")
+layout (location = 0) in vec4 model_coefficients;
+layout (location = 1) in vec4 normal_coefficients;
+layout (location = 2) in vec2 texture_coefficients;
+
+// Atributos por instância (glVertexAttribDivisor = 1)
+layout (location = 3) in vec4 path_center_radius; // Centro (xyz) e escala (w) da trajetória
+layout (location = 4) in vec4 path_params;        // Instante de criação, fase, formato e flag de alvo ativo
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time; // Mesmo relógio de "start_time" na MotionPool
+
+// Mesmos valores de "paths.h".
+const int PATH_MAX_SHAPES = 8;
+const int PATH_TABLE_SIZE = 256;
+
+// Tabelas dos formatos de trajetória (veja "paths.h"): uma linha por formato,
+// PATH_TABLE_SIZE posições igualmente espaçadas em comprimento de arco, e a
+// duração de uma volta em cada formato.
+uniform sampler2D path_table;
+uniform float path_period[PATH_MAX_SHAPES];
+
+out vec4 position_world;
+out vec4 position_model;
+out vec4 normal;
+out vec2 texcoords;
+
+// Mesma consulta de Paths_Sample() em "paths.cpp": a posição é interpolada
+// linearmente entre as duas amostras vizinhas da tabela.
+vec3 PathPosition()
+{
+    int shape = int(path_params.z);
+    float s = (time - path_params.x + path_params.y) / path_period[shape];
+    float u = fract(s) * float(PATH_TABLE_SIZE);
+    int i0 = min(int(u), PATH_TABLE_SIZE - 1);
+    int i1 = (i0 + 1) % PATH_TABLE_SIZE;
+
+    vec3 a = texelFetch(path_table, ivec2(i0, shape), 0).xyz;
+    vec3 b = texelFetch(path_table, ivec2(i1, shape), 0).xyz;
+    return path_center_radius.xyz + path_center_radius.w * mix(a, b, u - float(i0));
+}
+
+void main()
+{
+    // Instâncias de alvos removidos ou destruídos ficam fora do volume de
+    // visualização e são descartadas pelo clipping.
+    if (path_params.w == 0.0)
+    {
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        position_world = position_model = normal = vec4(0.0);
+        texcoords = vec2(0.0);
+        return;
+    }
+
+    // Matriz "model" equivalente a Matrix_Translate(posição) * Matrix_Scale(0.5)
+    // usada por DrawTarget() para os alvos parados.
+    vec3 center = PathPosition();
+    mat4 model = mat4(0.5, 0.0, 0.0, 0.0,
+                      0.0, 0.5, 0.0, 0.0,
+                      0.0, 0.0, 0.5, 0.0,
+                      center.x, center.y, center.z, 1.0);
+
+    position_world = model * model_coefficients;
+    position_model = model_coefficients;
+    gl_Position = projection * view * position_world;
+
+    // A escala é uniforme, então a normal não precisa da inversa transposta.
+    normal = vec4(normal_coefficients.xyz, 0.0);
+    texcoords = texture_coefficients;
+}
@@ -0,0 +1,501 @@
+// Simulação do jogo, sem OpenGL nem GLFW. Veja simulation.h.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "simulation.h"
+#include "profiler.h"
+#include "paths.h"
+#include "raycast.h"
+#include "rng.h"
+#include "systems.h"
+
+// Definida em collisions.cpp
+bool CheckCollisionWithWorld(const glm::vec4& cameraPosition);
+
+static const float CAMERA_SPEED = 4.0f;  // Velocidade do jogador
+static const float GRAVITY = 9.8f;
+static const float GROUND_LEVEL = 0.5f;  // Altura da câmera com o jogador no chão
+static const float JUMP_FORCE = 5.0f;    // Velocidade inicial do pulo
+static const float CAMERA_RADIUS = 0.5f; // Raio de colisão do jogador com os alvos
+
+// Converte um float uniforme u em [0,1) em um valor entre min e max em
+// intervalos de 0.5
+static float RandomHalfStep(float u, float min, float max) {
+    int range = static_cast<int>((max - min) * 2) + 1;
+    int step = static_cast<int>(u * range);
+    if (step >= range)
+        step = range - 1;
+    return min + step * 0.5f;
+}
+
+// Função para gerar um número float aleatório entre min e max em intervalos de 0.5
+static float RandomFloat(Rng& rng, float min, float max) {
+    return RandomHalfStep(rng.NextFloat(), min, max);
+}
+
+// Cria uma entidade para cada objeto do mapa: o primeiro é o chão e os
+// demais são as paredes e o teto.
+static void CreateMapEntities(World& world, GameMap& gameMap) {
+    std::vector<glm::mat4> modelos = gameMap.getModels();
+
+    for(size_t i = 0; i < modelos.size(); ++i){
+        EntityId entity = world.Create(ARCHETYPE_MAP_OBJECT);
+        world.GetStaticModel(entity)->model = modelos[i];
+
+        Renderable renderable = { (i != 0) ? PLANE_PAREDE : PLANE, "the_plane" };
+        *world.GetRenderable(entity) = renderable;
+    }
+}
+
+EntityId Simulation_SpawnTarget(Simulation& sim, double now, bool moving, double lifetime)
+{
+    // Gera coordenadas aleatórias para x, z e y de uma só vez
+    float u[3];
+    sim.rng[RNG_STREAM_SPAWN_POSITION].FillFloats(u, 3);
+    float x = RandomHalfStep(u[0], -6.0f, 6.0f);
+    float z = RandomHalfStep(u[1], -6.0f, 6.0f);
+    float y = RandomHalfStep(u[2], 1.0f, 4.0f);
+
+    // Alvos parados valem 10 pontos; alvos em movimento, 20. Estes não têm
+    // Renderable: são desenhados pela GPU a partir da MotionPool.
+    EntityId target = sim.world.Create(moving ? ARCHETYPE_MOVING_TARGET : ARCHETYPE_STATIC_TARGET);
+    Transform transform = { x, y, z, 0.5f };
+    Health health = { 1, moving ? 20 : 10 };
+    Lifetime expiration = { lifetime > 0.0 ? now + lifetime : HUGE_VAL };
+    Collider collider = { 0.5f };
+    *sim.world.GetTransform(target) = transform;
+    *sim.world.GetHealth(target) = health;
+    *sim.world.GetLifetime(target) = expiration;
+    *sim.world.GetCollider(target) = collider;
+
+    if (moving)
+    {
+        // Sorteia um dos formatos de trajetória e a registra (o formato
+        // sorteado, com escala 1, em torno do ponto sorteado) na MotionPool
+        int shape = static_cast<int>(sim.rng[RNG_STREAM_PATH].NextBelow(Paths_Count()));
+        Motion motion = { sim.motion.Allocate(x, y, z, 1.0f, (float)now, shape) };
+        *sim.world.GetMotion(target) = motion;
+    }
+    else
+    {
+        Renderable renderable = { SPHERE_PARADA, "the_sphere" };
+        *sim.world.GetRenderable(target) = renderable;
+    }
+
+    if (lifetime > 0.0)
+        sim.scheduler.Schedule(expiration.expire_time, EVENT_TARGET_EXPIRED, target);
+
+    SpawnRecord record = { target, now };
+    sim.spawn_history[sim.spawn_history_next] = record;
+    sim.spawn_history_next = (sim.spawn_history_next + 1) % SPAWN_HISTORY_SIZE;
+    ++sim.spawned;
+    return target;
+}
+
+// Processa, em ordem, todos os eventos com instante <= now. Cada criação de
+// alvo agenda a próxima, a partir do instante em que o evento deveria ocorrer.
+static void ProcessDueEvents(Simulation& sim, double now) {
+    PROFILE_SCOPE("criação de alvos");
+    Rng& timing = sim.rng[RNG_STREAM_SPAWN_TIMING];
+    GameEvent event;
+    while (sim.scheduler.PopDue(now, &event)) {
+        switch (event.type) {
+        case EVENT_SPAWN_TARGET:
+            if (event.payload != sim.round || sim.round_over)
+                break;
+            Simulation_SpawnTarget(sim, event.time, false, RandomFloat(sim.rng[RNG_STREAM_LIFETIME], 5.0f, 15.0f));
+            sim.scheduler.Schedule(event.time + RandomFloat(timing, 2.0f, 4.0f), EVENT_SPAWN_TARGET, sim.round);
+            break;
+        case EVENT_SPAWN_MOVING_TARGET:
+            if (event.payload != sim.round || sim.round_over)
+                break;
+            Simulation_SpawnTarget(sim, event.time, true, RandomFloat(sim.rng[RNG_STREAM_LIFETIME], 10.0f, 15.0f));
+            sim.scheduler.Schedule(event.time + RandomFloat(timing, 6.0f, 10.0f), EVENT_SPAWN_MOVING_TARGET, sim.round);
+            break;
+        case EVENT_TARGET_EXPIRED:
+            // Alvos já destruídos por um tiro são ignorados pelo World.
+            TargetSystem_Destroy(sim.world, sim.motion, event.payload);
+            break;
+        case EVENT_ROUND_END:
+            if (event.payload == sim.round)
+                sim.round_over = true;
+            break;
+        case EVENT_SHOT_READY:
+            sim.shot_ready = true;
+            break;
+        }
+    }
+}
+
+// Atualiza o tempo restante mostrado na tela. O fim da rodada em si é o
+// evento EVENT_ROUND_END.
+static void UpdateCountdown(Simulation& sim, double now) {
+    sim.countdown = static_cast<int>(ROUND_DURATION) - static_cast<int>(now - sim.round_start_time);
+    if (sim.countdown < 0 || sim.round_over) {
+        sim.countdown = 0;
+    }
+}
+
+void Simulation_Init(Simulation& sim, double now, uint64_t seed)
+{
+    Rng_SeedStreams(sim.rng, seed);
+
+    GameMap gameMap;
+    CreateMapEntities(sim.world, gameMap);
+
+    // A câmera começa a 3.5 da origem, olhando para ela; a gravidade a
+    // coloca no chão no primeiro quadro.
+    sim.camera_position = glm::vec4(0.0f, 0.0f, 3.5f, 1.0f);
+    sim.camera_velocity = glm::vec4(0.0f, 0.0f, 0.0f, 0.0f);
+    sim.camera_view_vector = glm::vec4(0.0f, 0.0f, -3.5f, 0.0f);
+    sim.camera_up_vector = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+
+    sim.round = 0;
+    sim.round_start_time = now;
+    sim.round_over = false;
+    sim.shot_ready = true;
+    sim.countdown = static_cast<int>(ROUND_DURATION);
+    sim.print_hits = true;
+    for (int i = 0; i < SPAWN_HISTORY_SIZE; ++i)
+    {
+        sim.spawn_history[i].entity = INVALID_ENTITY;
+        sim.spawn_history[i].time = 0.0;
+    }
+    sim.spawn_history_next = 0;
+    sim.snapshots = 0;
+    sim.spawned = 0;
+    sim.shots = 0;
+    sim.kills = 0;
+    sim.points = 0;
+
+    Simulation_StartRound(sim, now);
+}
+
+// Eventos ainda pendentes da rodada anterior são ignorados ao vencer.
+void Simulation_StartRound(Simulation& sim, double now)
+{
+    ++sim.round;
+    sim.round_start_time = now;
+    sim.round_over = false;
+
+    Rng& timing = sim.rng[RNG_STREAM_SPAWN_TIMING];
+    sim.scheduler.Schedule(now + ROUND_DURATION, EVENT_ROUND_END, sim.round);
+    sim.scheduler.Schedule(now + RandomFloat(timing, 2.0f, 4.0f), EVENT_SPAWN_TARGET, sim.round);
+    sim.scheduler.Schedule(now + RandomFloat(timing, 6.0f, 10.0f), EVENT_SPAWN_MOVING_TARGET, sim.round);
+}
+
+void Simulation_UpdateWorld(Simulation& sim, double now)
+{
+    // Cria e remove alvos, encerra a rodada e libera o próximo tiro, de
+    // acordo com os eventos que venceram desde o último quadro
+    ProcessDueEvents(sim, now);
+
+    // Afasta a câmera dos alvos e separa os alvos sobrepostos. A posição dos
+    // alvos em movimento só é avaliada quando pode haver colisão com a
+    // câmera ou com outro alvo.
+    CollisionSystem_Update(sim.world, sim.motion, (float)now, &sim.camera_position, CAMERA_RADIUS);
+}
+
+void Simulation_FireShots(Simulation& sim, const glm::vec4& origin, const ShotInput* shots, size_t count, double now)
+{
+    for (size_t i = 0; i < count; ++i) {
+        double shot_time = std::max(std::min(shots[i].time, now), now - SHOT_REWIND_MAX);
+        ProcessDueEvents(sim, shot_time);
+        if (!sim.shot_ready)
+            continue;
+        sim.shot_ready = false;
+        sim.scheduler.Schedule(now + SHOT_COOLDOWN, EVENT_SHOT_READY);
+        Simulation_FireAt(sim, origin, shots[i].direction, shots[i].time, now);
+    }
+}
+
+glm::vec4 Simulation_ViewVector(float theta, float phi)
+{
+    // Cálculo vx,vy,vz e aplicação no view vector
+    float vx = cos(phi) * sin(theta);
+    float vy = sin(phi);
+    float vz = cos(theta) * cos(phi);
+    return glm::vec4(-vx, vy, -vz, 0.0f);
+}
+
+void Simulation_UpdatePlayer(Simulation& sim, const PlayerInput& input, double now, float delta_t)
+{
+    PROFILE_SCOPE("jogador");
+    glm::vec4& camera_position_c = sim.camera_position;
+    glm::vec4& camera_velocity = sim.camera_velocity;
+
+    // Vetores W e U
+    glm::vec4 w_vector = -sim.camera_view_vector / norm(sim.camera_view_vector);
+    glm::vec4 u_vector = crossproduct(sim.camera_up_vector, w_vector) / norm(crossproduct(sim.camera_up_vector, w_vector));
+
+    // Movimentação da câmera
+    if(input.jump && camera_position_c.y == GROUND_LEVEL){
+        camera_velocity.y = JUMP_FORCE;
+        camera_position_c.y += camera_velocity.y * delta_t;
+    }
+    // Direção (para normalizar o movimento diagonal)
+    glm::vec4 direction(0.0f);
+
+    if(input.forward)
+        direction += -w_vector;
+    if(input.backward)
+        direction += w_vector;
+    if(input.left)
+        direction += -u_vector;
+    if(input.right)
+        direction += u_vector;
+
+    // Normaliza a direção do movimento
+    if ((norm(direction) * norm(direction)) > 0.0f) {
+        direction /= norm(direction);
+    }
+    direction.y = 0.0f;
+
+    // Atualiza a posição da câmera, considerando o botão shift
+    if(!input.walk){
+        camera_position_c += CAMERA_SPEED * delta_t * direction;
+    }
+    else{
+        camera_position_c += (CAMERA_SPEED/2.0f) * delta_t * direction;
+    }
+
+    if(CheckCollisionWithWorld(camera_position_c)){
+        camera_position_c -= CAMERA_SPEED * delta_t * direction;
+    }
+    if(input.restart){
+        Simulation_StartRound(sim, now);
+        sim.player.resetScore();
+    }
+
+    // Tiro contínuo com o botão segurado. Os cliques já foram disparados
+    // por Simulation_FireShots().
+    if(input.fire && sim.shot_ready){
+        sim.shot_ready = false;
+        sim.scheduler.Schedule(now + SHOT_COOLDOWN, EVENT_SHOT_READY);
+        Simulation_Fire(sim, input.aim_origin, input.aim_direction, now);
+    }
+
+    sim.camera_view_vector = Simulation_ViewVector(input.camera_theta, input.camera_phi);
+
+    if (camera_position_c.y > GROUND_LEVEL)
+    {
+        camera_velocity.y -= GRAVITY * delta_t;
+        camera_position_c.y += camera_velocity.y * delta_t;
+    }
+    if (camera_position_c.y <= GROUND_LEVEL)
+    {
+        camera_position_c.y = GROUND_LEVEL;
+        camera_velocity.y = 0;
+    }
+    if(!input.jump && camera_position_c.y == GROUND_LEVEL){
+        camera_velocity.y = 0;
+    }
+
+    UpdateCountdown(sim, now);
+}
+
+// Remove de "spheres" os alvos criados depois do instante "time".
+static void DropTargetsSpawnedAfter(const Simulation& sim, double time, SphereSet* spheres,
+                                    std::vector<EntityId>* sphere_to_entity)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < sphere_to_entity->size(); ++i)
+    {
+        EntityId entity = (*sphere_to_entity)[i];
+        bool spawned_after = false;
+        for (int h = 0; h < SPAWN_HISTORY_SIZE; ++h)
+            if (sim.spawn_history[h].entity == entity && sim.spawn_history[h].time > time)
+                spawned_after = true;
+        if (spawned_after)
+            continue;
+        spheres->center_x[kept] = spheres->center_x[i];
+        spheres->center_y[kept] = spheres->center_y[i];
+        spheres->center_z[kept] = spheres->center_z[i];
+        spheres->radius[kept] = spheres->radius[i];
+        (*sphere_to_entity)[kept] = entity;
+        ++kept;
+    }
+    spheres->center_x.resize(kept);
+    spheres->center_y.resize(kept);
+    spheres->center_z.resize(kept);
+    spheres->radius.resize(kept);
+    sphere_to_entity->resize(kept);
+}
+
+void Simulation_Fire(Simulation& sim, const glm::vec4& origin, const glm::vec4& direction, double now)
+{
+    Simulation_FireAt(sim, origin, direction, now, now);
+}
+
+void Simulation_FireAt(Simulation& sim, const glm::vec4& origin, const glm::vec4& direction,
+                       double shot_time, double now)
+{
+    PROFILE_SCOPE("tiro");
+    // Os pacotes ficam na simulação para reaproveitar a memória entre os
+    // tiros. Cada "pellet" de uma arma com vários projéteis seria um raio a
+    // mais no pacote; hoje a arma dispara um único raio.
+    RayPacket& rays = sim.shot_rays;
+    SphereSet& spheres = sim.shot_spheres;
+    std::vector<EntityId>& sphere_to_entity = sim.shot_entities;
+    std::vector<RayHit>& hits = sim.shot_hits;
+
+    ++sim.shots;
+    rays.Clear();
+    rays.Add(origin.x, origin.y, origin.z, direction.x, direction.y, direction.z);
+
+    // A posição dos alvos em movimento só é avaliada na CPU aqui, no
+    // instante do tiro, com a mesma função usada pelo vertex shader. Um
+    // clique entre dois passos volta a esse instante, como o jogador viu.
+    double rewind = std::max(std::min(shot_time, now), now - SHOT_REWIND_MAX);
+    MotionSystem_Sync(sim.world, sim.motion, (float)rewind);
+    TargetSystem_GatherSpheres(sim.world, &spheres, &sphere_to_entity);
+    if (rewind < now)
+        DropTargetsSpawnedAfter(sim, rewind, &spheres, &sphere_to_entity);
+
+    hits.resize(rays.Size());
+    TargetSystem_RayCast(rays, spheres, hits.data());
+
+    for (size_t i = 0; i < hits.size(); ++i) {
+        if (hits[i].index < 0)
+            continue;
+        EntityId entity = sphere_to_entity[hits[i].index];
+        Health* health = sim.world.GetHealth(entity);
+        if (health == NULL)
+            continue; // Já foi destruído por outro raio do mesmo pacote
+        --health->hp;
+        if (sim.print_hits)
+            printf("HP Left: %d\n", health->hp);
+        if (health->hp <= 0) {
+            sim.player.addScore(health->points);
+            TargetSystem_Destroy(sim.world, sim.motion, entity);
+            ++sim.kills;
+            sim.points += health->points;
+        }
+    }
+
+    // Os Transforms dos alvos em movimento voltam ao passo atual.
+    if (rewind < now)
+        MotionSystem_Sync(sim.world, sim.motion, (float)now);
+}
+
+void Simulation_TakeSnapshot(Simulation& sim, double now, SimulationSnapshot* out)
+{
+    PROFILE_SCOPE("snapshot");
+    out->world = sim.world;
+    out->motion = sim.motion;
+    sim.motion.dirty_slots.clear();
+
+    out->camera_position = sim.camera_position;
+    out->camera_view_vector = sim.camera_view_vector;
+    out->camera_up_vector = sim.camera_up_vector;
+    out->score = sim.player.getScore();
+    out->countdown = sim.countdown;
+    out->round_over = sim.round_over;
+    out->time = now;
+    out->sequence = ++sim.snapshots;
+}
+
+static void HashBytes(uint64_t* hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        *hash ^= bytes[i];
+        *hash *= 1099511628211ULL;
+    }
+}
+
+uint64_t Simulation_StateHash(const Simulation& sim)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    int score = sim.player.getScore();
+    HashBytes(&hash, &sim.round, sizeof(sim.round));
+    HashBytes(&hash, &score, sizeof(score));
+    HashBytes(&hash, &sim.round_over, sizeof(sim.round_over));
+    HashBytes(&hash, &sim.camera_position, sizeof(sim.camera_position));
+    HashBytes(&hash, &sim.camera_velocity, sizeof(sim.camera_velocity));
+    HashBytes(&hash, &sim.camera_view_vector, sizeof(sim.camera_view_vector));
+
+    const std::vector<Archetype>& archetypes = sim.world.Archetypes();
+    for (size_t a = 0; a < archetypes.size(); ++a)
+    {
+        const Archetype& archetype = archetypes[a];
+        if (!archetype.Matches(TARGET_COMPONENTS))
+            continue;
+        for (size_t i = 0; i < archetype.Size(); ++i)
+        {
+            HashBytes(&hash, &archetype.entities[i], sizeof(EntityId));
+            HashBytes(&hash, &archetype.transforms[i], sizeof(Transform));
+            HashBytes(&hash, &archetype.healths[i], sizeof(Health));
+        }
+    }
+    return hash;
+}
+
+// Jogador automático do modo headless: mira no alvo mais próximo, anda até
+// ele, atira sempre que pode e reinicia a rodada quando ela acaba.
+static PlayerInput HeadlessBot(Simulation& sim, double now)
+{
+    PlayerInput input;
+    input.restart = sim.round_over;
+    input.fire = sim.shot_ready;
+    input.aim_origin = sim.camera_position;
+
+    MotionSystem_Sync(sim.world, sim.motion, (float)now);
+    const std::vector<Archetype>& archetypes = sim.world.Archetypes();
+    float best = -1.0f;
+    glm::vec4 to_target(0.0f, 0.0f, -1.0f, 0.0f);
+    for (size_t a = 0; a < archetypes.size(); ++a)
+    {
+        const Archetype& archetype = archetypes[a];
+        if (!archetype.Matches(TARGET_COMPONENTS))
+            continue;
+        for (size_t i = 0; i < archetype.Size(); ++i)
+        {
+            const Transform& t = archetype.transforms[i];
+            glm::vec4 d(t.x - sim.camera_position.x, t.y - sim.camera_position.y, t.z - sim.camera_position.z, 0.0f);
+            float distance = norm(d);
+            if (distance > 0.0f && (best < 0.0f || distance < best))
+            {
+                best = distance;
+                to_target = d / distance;
+            }
+        }
+    }
+
+    // Ângulos que fazem o view vector (veja Simulation_UpdatePlayer())
+    // apontar para o alvo.
+    input.aim_direction = to_target;
+    input.camera_phi = std::asin(glm::clamp(to_target.y, -1.0f, 1.0f));
+    input.camera_theta = std::atan2(-to_target.x, -to_target.z);
+    input.forward = best > 2.0f;
+    return input;
+}
+
+void Simulation_StepHeadless(Simulation& sim, double now, double step)
+{
+    Simulation_UpdateWorld(sim, now);
+    PlayerInput input = HeadlessBot(sim, now);
+    Simulation_UpdatePlayer(sim, input, now, (float)step);
+}
+
+void Simulation_RunHeadless(double seconds, double step)
+{
+    Simulation sim;
+    Simulation_Init(sim, 0.0, Rng_SessionSeed());
+    sim.print_hits = false;
+
+    long steps = static_cast<long>(std::ceil(seconds / step));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (long i = 1; i <= steps; ++i)
+        Simulation_StepHeadless(sim, i * step, step);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Modo headless: %ld passos de %.4f s (%.1f s simulados) em %.3f s\n", steps, step, steps * step, wall);
+    printf("Passos por segundo: %.0f (%.1fx tempo real)\n", steps / wall, steps * step / wall);
+    printf("Rodadas: %d, alvos criados: %lu, tiros: %lu, alvos destruídos: %lu, pontos: %lu\n",
+           sim.round, sim.spawned, sim.shots, sim.kills, sim.points);
+}
@@ -0,0 +1,36 @@
+// Resumo de amostras de tempo. Veja stats.h.
+#include <algorithm>
+#include <cstdio>
+
+#include "stats.h"
+
+double Stats_Percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+void Stats_Print(const char* label, const char* unit, std::vector<double> values)
+{
+    if (values.empty())
+        return;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); ++i)
+        sum += values[i];
+    std::sort(values.begin(), values.end());
+
+    printf("%s (%s): média %.3f, p50 %.3f, p95 %.3f, p99 %.3f, máximo %.3f\n", label, unit,
+           sum / values.size(), Stats_Percentile(values, 0.50), Stats_Percentile(values, 0.95),
+           Stats_Percentile(values, 0.99), values.back());
+}
+
+void Stats_PrintFrames(const char* label, const std::vector<double>& frame_ms)
+{
+    if (frame_ms.empty())
+        return;
+    printf("Quadros: %zu\n", frame_ms.size());
+    Stats_Print(label, "ms", frame_ms);
+}
@@ -0,0 +1,227 @@
+// Teste de carga com populações crescentes de alvos. Veja stress.h.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "stress.h"
+#include "jobs.h"
+#include "raycast.h"
+#include "rng.h"
+#include "systems.h"
+
+typedef std::chrono::steady_clock StressClock;
+
+static double ElapsedMs(StressClock::time_point from, StressClock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// Etapas de um quadro, nós do grafo de tarefas. Cada etapa lê o que a
+// anterior escreve (posições dos alvos parados e da câmera), então o grafo
+// é uma cadeia; o paralelismo está dentro de cada etapa.
+static const char* const STRESS_MOTION = "carga: movimento";
+static const char* const STRESS_COLLISION = "carga: colisão";
+static const char* const STRESS_SEPARATION = "carga: separação";
+static const char* const STRESS_HIT_TEST = "carga: tiro";
+
+struct StressFrame
+{
+    Simulation* sim;
+    double now;
+    RayPacket rays;
+    SphereSet spheres;
+    std::vector<EntityId> sphere_to_entity;
+    RayHit hit;
+};
+
+static void StressMotion(void* data)
+{
+    StressFrame& frame = *static_cast<StressFrame*>(data);
+    MotionSystem_Sync(frame.sim->world, frame.sim->motion, (float)frame.now);
+}
+
+static void StressCollision(void* data)
+{
+    StressFrame& frame = *static_cast<StressFrame*>(data);
+    Simulation& sim = *frame.sim;
+    CollisionSystem_PushCamera(sim.world, sim.motion, (float)frame.now, &sim.camera_position, 0.5f);
+}
+
+static void StressSeparation(void* data)
+{
+    StressFrame& frame = *static_cast<StressFrame*>(data);
+    CollisionSystem_SeparateTargets(frame.sim->world, frame.sim->motion, (float)frame.now);
+}
+
+// Um tiro por quadro, que não destrói o alvo atingido para manter a
+// população.
+static void StressHitTest(void* data)
+{
+    StressFrame& frame = *static_cast<StressFrame*>(data);
+    const glm::vec4& c = frame.sim->camera_position;
+    const glm::vec4& v = frame.sim->camera_view_vector;
+    frame.rays.Clear();
+    frame.rays.Add(c.x, c.y, c.z, v.x, v.y, v.z);
+    TargetSystem_GatherSpheres(frame.sim->world, &frame.spheres, &frame.sphere_to_entity);
+    TargetSystem_RayCast(frame.rays, frame.spheres, &frame.hit);
+}
+
+// Soma a duração de cada etapa em StressPhaseTimes. As tarefas dos laços
+// paralelos dentro das etapas também passam por aqui e são ignoradas.
+static void StressTimingHook(const char* name, int, uint64_t begin_ns, uint64_t end_ns, void* user)
+{
+    StressPhaseTimes& total = *static_cast<StressPhaseTimes*>(user);
+    double ms = (end_ns - begin_ns) / 1e6;
+    if (name == STRESS_MOTION)
+        total.motion += ms;
+    else if (name == STRESS_COLLISION)
+        total.collision += ms;
+    else if (name == STRESS_SEPARATION)
+        total.separation += ms;
+    else if (name == STRESS_HIT_TEST)
+        total.hit_test += ms;
+}
+
+bool Stress_ParsePopulations(const char* list, std::vector<int>* populations)
+{
+    populations->clear();
+    const char* p = list;
+    while (*p != '\0')
+    {
+        char* end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value <= 0)
+            return false;
+        if (!populations->empty() && value < populations->back())
+            return false;
+        populations->push_back(static_cast<int>(value));
+        p = end;
+        if (*p == ',')
+            ++p;
+        else if (*p != '\0')
+            return false;
+    }
+    return !populations->empty();
+}
+
+void Stress_Run(const StressOptions& options, StressRenderFunction render, void* user)
+{
+    // A simulação começa sem a rodada normal: só existem o mapa e os alvos
+    // do teste, que não expiram.
+    Simulation sim;
+    Simulation_Init(sim, 0.0, Rng_SessionSeed());
+    sim.scheduler.Clear();
+    sim.print_hits = false;
+
+    FILE* csv = NULL;
+    if (options.csv_path != NULL)
+    {
+        csv = fopen(options.csv_path, "w");
+        if (csv == NULL)
+            fprintf(stderr, "ERRO: não foi possível criar \"%s\".\n", options.csv_path);
+        else
+            fprintf(csv, "populacao,alvos_parados,alvos_em_movimento,quadros,"
+                         "movimento_ms,colisao_ms,separacao_ms,tiro_ms,desenho_ms,total_ms\n");
+    }
+
+    printf("Threads: %d trabalhadoras e a principal (veja jobs.h)\n", Jobs_WorkerCount());
+    printf("%10s  %8s  %8s  %12s  %12s  %12s  %12s  %12s  %12s\n", "alvos", "parados", "quadros",
+           "movimento", "colisão", "separação", "tiro", "desenho", "total (ms)");
+
+    StressFrame frame;
+    frame.sim = &sim;
+    frame.now = 0.0;
+    JobGraph graph;
+    int motion = graph.Add(STRESS_MOTION, StressMotion, &frame);
+    int collision = graph.Add(STRESS_COLLISION, StressCollision, &frame);
+    int separation = graph.Add(STRESS_SEPARATION, StressSeparation, &frame);
+    int hit_test = graph.Add(STRESS_HIT_TEST, StressHitTest, &frame);
+    graph.Depends(collision, motion);
+    graph.Depends(separation, collision);
+    graph.Depends(hit_test, separation);
+
+    JobStats jobs_before;
+    Jobs_GetStats(&jobs_before);
+
+    double now = 0.0;
+    size_t moving = 0;
+    size_t population = 0;
+    size_t map_entities = sim.world.Count(0);
+    for (size_t p = 0; p < options.populations.size(); ++p)
+    {
+        size_t target = static_cast<size_t>(options.populations[p]);
+        if (map_entities + target > static_cast<size_t>(ENTITY_MAX_COUNT))
+        {
+            fprintf(stderr, "ERRO: a população %zu passa do limite de %d entidades (veja ecs.h).\n", target,
+                    ENTITY_MAX_COUNT);
+            break;
+        }
+
+        // Cria os alvos "spawn_rate" por quadro. Nesses quadros só há o
+        // desenho; a simulação completa é medida com a população estável.
+        while (population < target)
+        {
+            now += options.step;
+            for (int i = 0; i < options.spawn_rate && population < target; ++i)
+            {
+                ++population;
+                bool is_moving = moving < static_cast<size_t>(options.moving_fraction * population + 0.5f);
+                Simulation_SpawnTarget(sim, now, is_moving, 0.0);
+                if (is_moving)
+                    ++moving;
+            }
+            if (render != NULL)
+                render(sim, now, user);
+        }
+
+        // As etapas da simulação são medidas pelo gancho de tempo do
+        // sistema de tarefas; o desenho, nesta thread.
+        StressPhaseTimes total = { 0.0, 0.0, 0.0, 0.0, 0.0 };
+        Jobs_SetTimingHook(StressTimingHook, &total);
+        int frames = 0;
+        StressClock::time_point start = StressClock::now();
+        while (frames < options.frames)
+        {
+            now += options.step;
+            frame.now = now;
+            graph.Run();
+
+            StressClock::time_point t0 = StressClock::now();
+            if (render != NULL)
+                render(sim, now, user);
+            StressClock::time_point t1 = StressClock::now();
+            total.render += ElapsedMs(t0, t1);
+            ++frames;
+
+            if (ElapsedMs(start, t1) > options.max_seconds * 1000.0)
+                break;
+        }
+        Jobs_SetTimingHook(NULL, NULL);
+
+        StressPhaseTimes mean = {
+            total.motion / frames, total.collision / frames, total.separation / frames,
+            total.hit_test / frames, total.render / frames
+        };
+        double frame_ms = mean.motion + mean.collision + mean.separation + mean.hit_test + mean.render;
+
+        printf("%10zu  %8zu  %8d  %12.4f  %12.4f  %12.4f  %12.4f  %12.4f  %12.4f\n", population, population - moving,
+               frames, mean.motion, mean.collision, mean.separation, mean.hit_test, mean.render, frame_ms);
+        fflush(stdout);
+        if (csv != NULL)
+            fprintf(csv, "%zu,%zu,%zu,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n", population, population - moving, moving,
+                    frames, mean.motion, mean.collision, mean.separation, mean.hit_test, mean.render, frame_ms);
+    }
+
+    JobStats jobs_after;
+    Jobs_GetStats(&jobs_after);
+    printf("Tarefas: %llu executadas, %llu roubadas de outra thread\n",
+           (unsigned long long)(jobs_after.executed - jobs_before.executed),
+           (unsigned long long)(jobs_after.stolen - jobs_before.stolen));
+
+    if (csv != NULL)
+    {
+        fclose(csv);
+        printf("Curva de escala gravada em \"%s\".\n", options.csv_path);
+    }
+}
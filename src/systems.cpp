@@ -0,0 +1,262 @@
+// Sistemas do jogo que não dependem de OpenGL. Cada sistema percorre os
+// vetores de componentes dos arquétipos que lhe interessam; a única decisão
+// por tipo de entidade é a escolha dos arquétipos, feita uma vez por tabela.
+//
+// Os laços sobre muitos alvos são divididos em blocos com
+// Jobs_ParallelFor() (veja jobs.h). Cada bloco escreve só nas suas linhas,
+// e o resultado é o mesmo da execução em uma thread, bit a bit: os replays
+// (veja replay.h) não dependem do número de threads.
+#include <algorithm>
+#include <cmath>
+
+#include "systems.h"
+#include "jobs.h"
+#include "profiler.h"
+
+// Índices por bloco de cada laço paralelo: o suficiente para que o custo de
+// criar e esperar a tarefa (alguns microssegundos) fique pequeno.
+static const size_t COPY_GRAIN = 8192;       // Cópias de posições
+// A separação divide o laço de cada alvo que empurra, então só vale a pena
+// com muitos alvos empurrados; abaixo disso o laço é executado direto.
+static const size_t SEPARATION_GRAIN = 16384; // Alvos empurrados por um mesmo alvo
+static const size_t RAYCAST_GRAIN = 16384;   // Esferas por raio
+
+void MotionSystem_Sync(World& world, MotionPool& motion, float now)
+{
+    PROFILE_SCOPE("movimento");
+    Motion_EvaluateBatch(motion, now);
+
+    std::vector<Archetype>& archetypes = world.Archetypes();
+    for (size_t a = 0; a < archetypes.size(); ++a)
+    {
+        Archetype& archetype = archetypes[a];
+        if (!archetype.Matches(COMPONENT_TRANSFORM | COMPONENT_MOTION))
+            continue;
+        Jobs_ParallelFor("movimento: transforms", archetype.Size(), COPY_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                int slot = archetype.motions[i].slot;
+                archetype.transforms[i].x = motion.pos_x[slot];
+                archetype.transforms[i].y = motion.pos_y[slot];
+                archetype.transforms[i].z = motion.pos_z[slot];
+            }
+        });
+    }
+}
+
+// Afasta o ponto p do ponto fixo c, em passos de "step" ao longo da direção
+// c->p, até que a distância entre eles seja maior que "reach". Equivale a
+// repetir p += step*direção enquanto houver colisão.
+static void PushApart(float* px, float* py, float* pz, float cx, float cy, float cz, float reach, float step)
+{
+    float dx = *px - cx;
+    float dy = *py - cy;
+    float dz = *pz - cz;
+    float distance = std::sqrt(dx*dx + dy*dy + dz*dz);
+    if (distance > reach || distance == 0.0f)
+        return;
+
+    float steps = std::floor((reach - distance) / step) + 1.0f;
+    float scale = steps * step / distance;
+    *px += dx * scale;
+    *py += dy * scale;
+    *pz += dz * scale;
+}
+
+// Posição de um alvo que talvez ainda não tenha sido avaliada neste quadro.
+// "known" guarda, para as linhas de arquétipos com Motion, se o Transform já
+// foi atualizado.
+static bool EnsurePosition(Archetype& archetype, size_t row, std::vector<char>& known,
+                           const MotionPool& motion, float now, float x, float y, float z, float distance)
+{
+    if (!(archetype.mask & COMPONENT_MOTION) || known[row])
+        return true;
+
+    int slot = archetype.motions[row].slot;
+    if (!Motion_MayBeNear(motion, slot, x, y, z, distance))
+        return false;
+
+    Transform& t = archetype.transforms[row];
+    Motion_Evaluate(motion, slot, now, &t.x, &t.y, &t.z);
+    known[row] = 1;
+    return true;
+}
+
+void CollisionSystem_PushCamera(World& world, const MotionPool& motion, float now, glm::vec4* camera, float camera_radius)
+{
+    // Locais, e não estáticos: várias simulações podem estar nesta função
+    // ao mesmo tempo (veja session.h).
+    std::vector<Archetype>& archetypes = world.Archetypes();
+    std::vector<char> known;
+    for (size_t a = 0; a < archetypes.size(); ++a)
+    {
+        Archetype& archetype = archetypes[a];
+        if (!archetype.Matches(TARGET_COMPONENTS))
+            continue;
+        known.assign(archetype.Size(), 0);
+
+        for (size_t i = 0; i < archetype.Size(); ++i)
+        {
+            float reach = camera_radius + archetype.colliders[i].radius;
+            if (!EnsurePosition(archetype, i, known, motion, now, camera->x, camera->y, camera->z, reach))
+                continue;
+            const Transform& t = archetype.transforms[i];
+            PushApart(&camera->x, &camera->y, &camera->z, t.x, t.y, t.z, reach, 0.01f);
+        }
+    }
+}
+
+void CollisionSystem_SeparateTargets(World& world, const MotionPool& motion, float now)
+{
+    std::vector<Archetype>& archetypes = world.Archetypes();
+
+    // Alvos parados são empurrados pelos demais alvos.
+    std::vector<Archetype*> pushable;
+    for (size_t a = 0; a < archetypes.size(); ++a)
+        if (archetypes[a].Matches(TARGET_COMPONENTS, COMPONENT_MOTION))
+            pushable.push_back(&archetypes[a]);
+
+    for (size_t a = 0; a < archetypes.size(); ++a)
+    {
+        Archetype& archetype = archetypes[a];
+        if (!archetype.Matches(TARGET_COMPONENTS))
+            continue;
+        bool moving = (archetype.mask & COMPONENT_MOTION) != 0;
+
+        for (size_t i = 0; i < archetype.Size(); ++i)
+        {
+            float radius = archetype.colliders[i].radius;
+
+            // A posição de um alvo em movimento só é avaliada a partir do
+            // primeiro alvo parado de que a trajetória pode passar perto;
+            // os anteriores certamente estão fora do alcance.
+            size_t first_b = 0;
+            size_t first_j = 0;
+            if (moving)
+            {
+                // A busca termina no primeiro alvo ao alcance, então é
+                // sequencial: dividida em blocos, todos seriam percorridos.
+                int slot = archetype.motions[i].slot;
+                for (first_b = 0; first_b < pushable.size(); ++first_b)
+                {
+                    const Archetype& other = *pushable[first_b];
+                    for (first_j = 0; first_j < other.Size(); ++first_j)
+                    {
+                        const Transform& o = other.transforms[first_j];
+                        if (Motion_MayBeNear(motion, slot, o.x, o.y, o.z, radius + other.colliders[first_j].radius))
+                            break;
+                    }
+                    if (first_j < other.Size())
+                        break;
+                }
+                if (first_b == pushable.size())
+                    continue;
+                Transform& t = archetype.transforms[i];
+                Motion_Evaluate(motion, slot, now, &t.x, &t.y, &t.z);
+            }
+
+            // O outro alvo é afastado. Alvos em movimento seguem sua
+            // trajetória e não são empurrados. Cada bloco empurra alvos
+            // diferentes, todos pelo mesmo alvo i.
+            const Transform& t = archetype.transforms[i];
+            for (size_t b = first_b; b < pushable.size(); ++b)
+            {
+                Archetype& other = *pushable[b];
+                size_t skip = b == first_b ? first_j : 0;
+                Jobs_ParallelFor("separação", other.Size() - skip, SEPARATION_GRAIN, [&](size_t begin, size_t end) {
+                    for (size_t j = skip + begin; j < skip + end; ++j)
+                    {
+                        if (&other == &archetype && j == i)
+                            continue;
+                        Transform& o = other.transforms[j];
+                        float separation = radius + other.colliders[j].radius;
+                        PushApart(&o.x, &o.y, &o.z, t.x, t.y, t.z, separation, 0.1f);
+                    }
+                });
+            }
+        }
+    }
+}
+
+void CollisionSystem_Update(World& world, const MotionPool& motion, float now, glm::vec4* camera, float camera_radius)
+{
+    PROFILE_SCOPE("colisão");
+    CollisionSystem_PushCamera(world, motion, now, camera, camera_radius);
+    CollisionSystem_SeparateTargets(world, motion, now);
+}
+
+void TargetSystem_GatherSpheres(const World& world, SphereSet* spheres, std::vector<EntityId>* sphere_to_entity)
+{
+    const std::vector<Archetype>& archetypes = world.Archetypes();
+    size_t total = 0;
+    for (size_t a = 0; a < archetypes.size(); ++a)
+        if (archetypes[a].Matches(TARGET_COMPONENTS))
+            total += archetypes[a].Size();
+
+    spheres->center_x.resize(total);
+    spheres->center_y.resize(total);
+    spheres->center_z.resize(total);
+    spheres->radius.resize(total);
+    sphere_to_entity->resize(total);
+
+    size_t offset = 0;
+    for (size_t a = 0; a < archetypes.size(); ++a)
+    {
+        const Archetype& archetype = archetypes[a];
+        if (!archetype.Matches(TARGET_COMPONENTS))
+            continue;
+        Jobs_ParallelFor("tiro: esferas", archetype.Size(), COPY_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const Transform& t = archetype.transforms[i];
+                spheres->center_x[offset + i] = t.x;
+                spheres->center_y[offset + i] = t.y;
+                spheres->center_z[offset + i] = t.z;
+                spheres->radius[offset + i] = archetype.colliders[i].radius;
+                (*sphere_to_entity)[offset + i] = archetype.entities[i];
+            }
+        });
+        offset += archetype.Size();
+    }
+}
+
+void TargetSystem_RayCast(const RayPacket& rays, const SphereSet& spheres, RayHit* hits)
+{
+    size_t chunks = (spheres.Size() + RAYCAST_GRAIN - 1) / RAYCAST_GRAIN;
+    if (Jobs_WorkerCount() == 0 || chunks <= 1)
+    {
+        RayCast_NearestHits(rays, spheres, hits);
+        return;
+    }
+
+    // Cada bloco de esferas dá o mais próximo de cada raio dentro do bloco;
+    // na redução, os blocos são visitados em ordem e só uma distância
+    // menor substitui a anterior, então os empates ficam com o menor
+    // índice, como em RayCast_NearestHits().
+    chunks = std::min<size_t>(chunks, JOBS_MAX_CHUNKS);
+    std::vector<RayHit> partial(chunks * rays.Size());
+    Jobs_ParallelFor("tiro: raios", chunks, 1, [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c)
+            RayCast_NearestHitsRange(rays, spheres, spheres.Size() * c / chunks, spheres.Size() * (c + 1) / chunks,
+                                     &partial[c * rays.Size()]);
+    });
+
+    for (size_t ray = 0; ray < rays.Size(); ++ray)
+    {
+        hits[ray] = partial[ray];
+        for (size_t c = 1; c < chunks; ++c)
+        {
+            const RayHit& hit = partial[c * rays.Size() + ray];
+            if (hit.index >= 0 && hit.distance < hits[ray].distance)
+                hits[ray] = hit;
+        }
+    }
+}
+
+void TargetSystem_Destroy(World& world, MotionPool& motion, EntityId id)
+{
+    Motion* m = world.GetMotion(id);
+    if (m != NULL)
+        motion.Release(m->slot);
+    world.Destroy(id);
+}
@@ -8,8 +8,9 @@
 #include <glm/mat4x4.hpp>
 #include <glm/vec4.hpp>
 
-#include "utils.h"
 #include "dejavufont.h"
+#include "profiler.h"
+#include "gl_debug.h"
 
 GLuint CreateGpuProgram(GLuint vertex_shader_id, GLuint fragment_shader_id); // Função definida em main.cpp
 
@@ -89,6 +90,7 @@ GLuint texttexture_id;
 
 void TextRendering_Init()
 {
+    PROFILE_SCOPE("carregar fonte");
     GLuint sampler;
 
     glGenBuffers(1, &textVBO);
@@ -99,30 +101,27 @@ void TextRendering_Init()
     glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glCheckError();
 
     GLuint textvertexshader_id = glCreateShader(GL_VERTEX_SHADER);
     TextRendering_LoadShader(textvertexshader_source, textvertexshader_id);
-    glCheckError();
 
     GLuint textfragmentshader_id = glCreateShader(GL_FRAGMENT_SHADER);
     TextRendering_LoadShader(textfragmentshader_source, textfragmentshader_id);
-    glCheckError();
 
     textprogram_id = CreateGpuProgram(textvertexshader_id, textfragmentshader_id);
     glLinkProgram(textprogram_id);
-    glCheckError();
+    GL_DEBUG_LABEL(GL_PROGRAM, textprogram_id, "texto");
 
     GLuint texttex_uniform;
     texttex_uniform = glGetUniformLocation(textprogram_id, "tex");
-    glCheckError();
 
     GLuint textureunit = 31;
     glActiveTexture(GL_TEXTURE0 + textureunit);
     glBindTexture(GL_TEXTURE_2D, texttexture_id);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, dejavufont.tex_width, dejavufont.tex_height, 0, GL_RED, GL_UNSIGNED_BYTE, dejavufont.tex_data);
     glBindSampler(textureunit, sampler);
-    glCheckError();
+    GL_DEBUG_LABEL(GL_TEXTURE, texttexture_id, "fonte do texto");
+    GL_DEBUG_LABEL(GL_SAMPLER, sampler, "fonte do texto");
 
     glBindVertexArray(textVAO);
 
@@ -130,16 +129,15 @@ void TextRendering_Init()
     glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
     glEnableVertexAttribArray(0);
-    glCheckError();
+    GL_DEBUG_LABEL(GL_VERTEX_ARRAY, textVAO, "texto");
+    GL_DEBUG_LABEL(GL_BUFFER, textVBO, "vértices do texto");
 
     glUseProgram(textprogram_id);
     glUniform1i(texttex_uniform, textureunit);
     glUseProgram(0);
-    glCheckError();
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
-    glCheckError();
 }
 
 float textscale = 1.5f;
@@ -152,6 +150,18 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
     float sx = scale / width;
     float sy = scale / height;
 
+    // O estado do desenho do texto é ligado uma vez por string e não é
+    // desfeito ao final: quem desenha depois liga o estado de que precisa
+    // (veja DrawGameScene() e gl_state.h).
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    glDepthFunc(GL_ALWAYS);
+    glUseProgram(textprogram_id);
+    glBindVertexArray(textVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, textVBO);
+
     for (size_t i = 0; i < str.size(); i++)
     {
         // Find the glyph for the character we are looking for
@@ -187,26 +197,9 @@ void TextRendering_PrintString(GLFWwindow* window, const std::string &str, float
             { x1, y0, s1, t0 }
         };
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-        glDepthFunc(GL_ALWAYS);
-        glBindBuffer(GL_ARRAY_BUFFER, textVBO);
         glBufferSubData(GL_ARRAY_BUFFER, 0, 24 * sizeof(float), data);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        glUseProgram(textprogram_id);
-        glBindVertexArray(textVAO);
-
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-        glBindVertexArray(0);
-        glUseProgram(0);
-        glDepthFunc(GL_LESS);
-
-        glDisable(GL_BLEND);
-
         x += (glyph->advance_x * sx);
     }
 }